@@ -0,0 +1,72 @@
+#include <xdx/cliopts/bulk_convert.hpp>
+#include <xdx/cliopts/value_parser.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+
+namespace
+{
+
+constexpr size_t COUNT = 1000000;
+constexpr int ROUNDS = 5;
+
+template <class Function>
+double best_of(Function&& function) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = round == 0 || elapsed.count() < best ? elapsed.count() : best;
+    }
+    return best;
+}
+
+// Converts same texts through convert_bulk() and through parse_value() one by one, returns false if
+// results differ.
+template <class ValueType>
+bool compare(const char* name, const std::vector<std::string>& texts) {
+    const std::vector<std::string_view> views(texts.begin(), texts.end());
+    std::vector<ValueType> bulk(views.size());
+    std::vector<ValueType> scalar(views.size());
+
+    const double bulk_ns = best_of([&]() { convert_bulk(views.data(), views.size(), bulk.data()); });
+    const double scalar_ns = best_of([&]() {
+        std::optional<ValueType> value;
+        for (size_t idx = 0; idx < views.size(); ++idx) {
+            parse_value(views[idx], &value);
+            scalar[idx] = *value;
+        }
+    });
+
+    std::printf("%-20s bulk %6.1f ns/value, scalar %6.1f ns/value, speedup %.2fx\n", name, bulk_ns / views.size(),
+                scalar_ns / views.size(), scalar_ns / bulk_ns);
+    if (bulk != scalar) {
+        std::printf("%-20s results differ\n", name);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 random{42};
+    std::vector<std::string> integers(COUNT);
+    std::vector<std::string> doubles(COUNT);
+    for (size_t idx = 0; idx < COUNT; ++idx) {
+        integers[idx] = std::to_string(random() % 100000000000ull);
+        doubles[idx] = std::to_string(static_cast<double>(random() % 1000000) / 1000);
+    }
+
+    bool same = compare<unsigned long long>("unsigned long long", integers);
+    same = compare<long>("long", integers) && same;
+    same = compare<double>("double", doubles) && same;
+    return same ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/parser.hpp>
+#include <xdx/cliopts/schema.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+
+namespace
+{
+
+constexpr size_t COUNT = 5000;
+constexpr size_t SUBCOMMANDS = 100;
+constexpr int ROUNDS = 5;
+
+struct Schema
+{
+    std::vector<std::string> names;
+    std::vector<FlagSpec> flags;
+    std::vector<ArgumentSpec<int>> arguments;
+};
+
+Schema generate() {
+    Schema schema;
+    for (size_t i = 0; i < 2 * COUNT; ++i) {
+        schema.names.push_back("option-" + std::to_string(i));
+    }
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        schema.flags.push_back({'\0', schema.names[2 * i], "generated flag", i % 2 == 0});
+        schema.arguments.push_back({'\0', schema.names[2 * i + 1], "generated argument"});
+    }
+    return schema;
+}
+
+OptionsPtr build(const Schema& schema) {
+    auto builder = Builder("tool", "generated options").flags(schema.flags).arguments<int>(schema.arguments);
+    for (size_t i = 0; i < SUBCOMMANDS; ++i) {
+        builder.add_subcommand(Builder("sub-" + std::to_string(i), "generated subcommand").get_options());
+    }
+    builder.get_options()->compile();
+    return builder.get_options();
+}
+
+bool parse(const OptionsPtr& options) {
+    const char* argv[] = {"tool", "--option-0", "--option-1", "1", "--option-9999", "2", "sub-42"};
+    return !Parser(options).process({static_cast<int>(std::size(argv)), argv}).error;
+}
+
+// Best time of few rounds in microseconds, `run` returns false on failure.
+template <class Function>
+double best_of(Function&& run, bool* ok) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        *ok = run() && *ok;
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        best = round == 0 || elapsed.count() < best ? elapsed.count() : best;
+    }
+    return best;
+}
+
+}  // namespace
+
+// Startup cost of a tool with generated schema of COUNT flags, COUNT arguments and SUBCOMMANDS
+// subcommands: registration with duplicate checks and compile, then the first parse, and the same
+// through a serialized schema.
+int main() {
+    const auto schema = generate();
+    bool ok = true;
+
+    const double build_us = best_of([&]() { return build(schema) != nullptr; }, &ok);
+    const double build_parse_us = best_of([&]() { return parse(build(schema)); }, &ok);
+
+    const auto blob = serialize_schema(*build(schema));
+    const double load_us = best_of([&]() { return load_schema(std::string_view{blob}) != nullptr; }, &ok);
+    const double load_parse_us = best_of([&]() { return parse(load_schema(std::string_view{blob})); }, &ok);
+
+    std::printf("%zu flags, %zu arguments, %zu subcommands, schema blob %zu bytes\n", COUNT, COUNT, SUBCOMMANDS,
+                blob.size());
+    std::printf("build and compile   %10.1f us\n", build_us);
+    std::printf("  and first parse   %10.1f us\n", build_parse_us);
+    std::printf("load schema         %10.1f us\n", load_us);
+    std::printf("  and first parse   %10.1f us\n", load_parse_us);
+    if (!ok) {
+        std::printf("parse failed\n");
+    }
+    return ok ? 0 : 1;
+}
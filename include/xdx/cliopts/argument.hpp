@@ -1,9 +1,14 @@
 #pragma once
 
-#include <xdx/cliopts/details/from_string.hpp>
+#include <xdx/cliopts/details/node_kinds.hpp>
+#include <xdx/cliopts/details/split.hpp>
+#include <xdx/cliopts/details/state_codec.hpp>
+#include <xdx/cliopts/details/string_pool.hpp>
+#include <xdx/cliopts/value_parser.hpp>
 
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -25,6 +30,35 @@ struct iArgument
     virtual bool is_many_values() const noexcept = 0;
     virtual void reset_to_default() noexcept = 0;
     virtual std::pair<bool, std::string> set_string_value(const std::string_view& value) noexcept = 0;
+
+    // Moves names into pool of options the argument is added to. Arguments which don't own strings ignore it.
+    virtual void attach_strings(const details::StringPoolPtr& /*pool*/) {
+    }
+
+    // Values accepted by argument restricted to fixed set, used for help and error messages
+    virtual size_t allowed_values_count() const noexcept {
+        return 0;
+    }
+
+    virtual std::string_view get_allowed_value(size_t /*idx*/) const noexcept {
+        return {};
+    }
+
+    // Raw copy of values given on command line, see serialize_state(). Returns false and writes nothing
+    // when argument holds default only. Throws std::logic_error if argument doesn't support it.
+    virtual bool save_state(details::StateWriter& /*out*/) const {
+        throw std::logic_error("argument '" + std::string(get_long_name()) + "' doesn't support state export");
+    }
+
+    virtual void restore_state(details::StateReader& /*in*/) {
+        throw std::logic_error("argument '" + std::string(get_long_name()) + "' doesn't support state export");
+    }
+
+    // Built-in kinds of built-in value types return themselves, so ArgumentRef calls their final
+    // overrides directly.
+    virtual details::ArgumentVariant typed_ref() noexcept {
+        return details::ArgumentVariant{std::in_place_index<0>, this};
+    }
 };
 
 class ArgumentBase : public iArgument
@@ -33,17 +67,20 @@ public:
     ArgumentBase(const std::string_view& long_name, const std::string_view& description)
         : long_name_{long_name}
         , description_{description} {
+        own_strings();
     }
 
     ArgumentBase(char short_name, const std::string_view& description)
         : short_name_{short_name}
         , description_{description} {
+        own_strings();
     }
 
     ArgumentBase(char short_name, const std::string_view& long_name, const std::string_view& description)
         : short_name_{short_name}
         , long_name_{long_name}
         , description_{description} {
+        own_strings();
     }
 
     bool is_required() const noexcept final {
@@ -52,6 +89,7 @@ public:
 
     void set_type_name(const std::string_view& type_name) {
         type_name_ = type_name;
+        own_strings();
     }
 
     void set_required(bool required = true) {
@@ -74,12 +112,22 @@ public:
         return type_name_;
     }
 
+    void attach_strings(const details::StringPoolPtr& pool) override {
+        strings_.attach(pool, {&long_name_, &description_, &type_name_});
+    }
+
+private:
+    void own_strings() {
+        strings_.own({&long_name_, &description_, &type_name_});
+    }
+
 private:
     char short_name_ = '\0';
     bool is_required_ = false;
-    std::string long_name_;
-    std::string description_;
-    std::string type_name_;
+    std::string_view long_name_;
+    std::string_view description_;
+    std::string_view type_name_;
+    details::NodeStrings strings_;
 };
 
 template <class ValueType>
@@ -100,13 +148,7 @@ public:
 
 public:
     std::string_view get_default_value() const final {
-        if (!has_default_value()) {
-            return {};
-        }
-
-        std::ostringstream stream;
-        stream << *default_value_;
-        return stream.str();
+        return default_text_;
     }
 
     bool has_default_value() const noexcept final {
@@ -114,7 +156,7 @@ public:
     }
 
     std::pair<bool, std::string> set_string_value(const std::string_view& str_value) noexcept final {
-        return details::from_string(&value_, (std::string{str_value}));
+        return parse_value(str_value, &value_);
     }
 
     bool has_value() const noexcept final {
@@ -123,22 +165,43 @@ public:
 
     void set_default_value(const ValueType& v) {
         default_value_ = v;
+
+        std::ostringstream stream;
+        stream << v;
+        default_text_ = stream.str();
     }
 
     ValueType get_value() const noexcept {
         return value_ ? *value_ : *default_value_;
     }
 
+    bool save_state(details::StateWriter& out) const final {
+        if (!value_) {
+            return false;
+        }
+        out.value(*value_);
+        return true;
+    }
+
+    void restore_state(details::StateReader& in) final {
+        value_ = in.value<ValueType>();
+    }
+
     bool is_many_values() const noexcept override {
         return false;
     }
 
+    details::ArgumentVariant typed_ref() noexcept final {
+        return details::make_node_variant<details::ArgumentVariant>(this);
+    }
+
     void reset_to_default() noexcept final {
         value_.reset();
     }
 
 private:
     std::optional<ValueType> default_value_;
+    std::string default_text_;
     std::optional<ValueType> value_;
 };
 
@@ -160,13 +223,7 @@ public:
 
 public:
     std::string_view get_default_value() const final {
-        if (!has_default_value()) {
-            return {};
-        }
-
-        std::ostringstream stream;
-        stream << *default_value_;
-        return stream.str();
+        return default_text_;
     }
 
     bool has_default_value() const noexcept final {
@@ -174,8 +231,12 @@ public:
     }
 
     std::pair<bool, std::string> set_string_value(const std::string_view& str_value) noexcept final {
+        if (delimiter_ != '\0') {
+            return details::parse_delimited(str_value, delimiter_, escape_, &values_);
+        }
+
         std::optional<ValueType> val;
-        auto parse_res = details::from_string(&val, (std::string{str_value}));
+        auto parse_res = parse_value(str_value, &val);
 
         if (!parse_res.first) {
             return parse_res;
@@ -186,29 +247,327 @@ public:
         return {true, std::string{}};
     }
 
+    // Lets single occurrence carry many values, e.g. `--ids=1,2,3`. Escaping is off unless `escape` is given,
+    // so values like `C:\a,C:\b` keep backslashes. With escape, escaped delimiter is kept in value.
+    void set_delimiter(char delimiter, char escape = '\0') {
+        delimiter_ = delimiter;
+        escape_ = escape;
+    }
+
+    char get_delimiter() const noexcept {
+        return delimiter_;
+    }
+
+    char get_escape() const noexcept {
+        return escape_;
+    }
+
     bool has_value() const noexcept final {
         return !values_.empty() || has_default_value();
     }
 
     void set_default_value(const ValueType& v) {
         default_value_ = v;
+
+        std::ostringstream stream;
+        stream << v;
+        default_text_ = stream.str();
     }
 
     bool is_many_values() const noexcept override {
         return true;
     }
 
+    details::ArgumentVariant typed_ref() noexcept final {
+        return details::make_node_variant<details::ArgumentVariant>(this);
+    }
+
     std::vector<ValueType> get_values() const noexcept {
         return !values_.empty() ? values_ : std::vector<ValueType>{*default_value_};
     }
 
+    bool save_state(details::StateWriter& out) const final {
+        if (values_.empty()) {
+            return false;
+        }
+        out.values(values_);
+        return true;
+    }
+
+    void restore_state(details::StateReader& in) final {
+        in.values(&values_);
+    }
+
     void reset_to_default() noexcept final {
         values_.clear();
     }
 
 private:
+    char delimiter_ = '\0';
+    char escape_ = '\0';
     std::optional<ValueType> default_value_;
+    std::string default_text_;
     std::vector<ValueType> values_;
 };
 
+// Converts values straight into caller owned variable. If argument is not required, value the
+// variable holds at binding time becomes the default and is restored by reset_to_default(). The default
+// is moved aside on the first write and moved back on reset, so restoring it doesn't copy or allocate.
+template <class ValueType>
+class BoundArgument : public ArgumentBase
+{
+public:
+    BoundArgument(ValueType* target, const std::string_view& long_name, const std::string_view& description)
+        : ArgumentBase{long_name, description}
+        , target_{target} {
+    }
+
+    BoundArgument(ValueType* target, char short_name, const std::string_view& description)
+        : ArgumentBase{short_name, description}
+        , target_{target} {
+    }
+
+    BoundArgument(ValueType* target, char short_name, const std::string_view& long_name,
+                  const std::string_view& description)
+        : ArgumentBase{short_name, long_name, description}
+        , target_{target} {
+    }
+
+public:
+    std::string_view get_default_value() const final {
+        return default_text_;
+    }
+
+    bool has_default_value() const noexcept final {
+        return has_default_;
+    }
+
+    std::pair<bool, std::string> set_string_value(const std::string_view& str_value) noexcept final {
+        std::optional<ValueType> val;
+        auto parse_res = parse_value(str_value, &val);
+
+        if (!parse_res.first) {
+            return parse_res;
+        }
+
+        _save_default();
+        *target_ = std::move(*val);
+
+        return {true, std::string{}};
+    }
+
+    bool has_value() const noexcept final {
+        return was_ || has_default_value();
+    }
+
+    // takes current value of the bound variable as default
+    void bind_default_value() {
+        std::ostringstream stream;
+        stream << *target_;
+        default_text_ = stream.str();
+
+        if (was_) {
+            saved_default_ = *target_;
+        }
+        has_default_ = true;
+    }
+
+    bool is_many_values() const noexcept override {
+        return false;
+    }
+
+    details::ArgumentVariant typed_ref() noexcept final {
+        return details::make_node_variant<details::ArgumentVariant>(this);
+    }
+
+    void reset_to_default() noexcept final {
+        if (saved_default_) {
+            *target_ = std::move(*saved_default_);
+            saved_default_.reset();
+        }
+        was_ = false;
+    }
+
+    bool save_state(details::StateWriter& out) const final {
+        if (!was_) {
+            return false;
+        }
+        out.value(*target_);
+        return true;
+    }
+
+    void restore_state(details::StateReader& in) final {
+        auto value = in.value<ValueType>();
+        _save_default();
+        *target_ = std::move(value);
+    }
+
+private:
+    void _save_default() noexcept {
+        if (!was_ && has_default_) {
+            saved_default_.emplace(std::move(*target_));
+        }
+        was_ = true;
+    }
+
+private:
+    ValueType* target_;
+    bool was_ = false;
+    bool has_default_ = false;
+    // holds the default while the variable holds parsed value
+    std::optional<ValueType> saved_default_;
+    std::string default_text_;
+};
+
+// Appends values to caller owned vector. The first parsed value replaces whatever vector held, which is
+// kept aside and moved back by reset_to_default() if it was bound as default.
+template <class ValueType>
+class BoundArgumentList : public ArgumentBase
+{
+public:
+    BoundArgumentList(std::vector<ValueType>* target, const std::string_view& long_name,
+                      const std::string_view& description)
+        : ArgumentBase{long_name, description}
+        , target_{target} {
+    }
+
+    BoundArgumentList(std::vector<ValueType>* target, char short_name, const std::string_view& description)
+        : ArgumentBase{short_name, description}
+        , target_{target} {
+    }
+
+    BoundArgumentList(std::vector<ValueType>* target, char short_name, const std::string_view& long_name,
+                      const std::string_view& description)
+        : ArgumentBase{short_name, long_name, description}
+        , target_{target} {
+    }
+
+public:
+    std::string_view get_default_value() const final {
+        return default_text_;
+    }
+
+    bool has_default_value() const noexcept final {
+        return has_default_;
+    }
+
+    std::pair<bool, std::string> set_string_value(const std::string_view& str_value) noexcept final {
+        if (delimiter_ != '\0') {
+            const bool first = !was_;
+            _save_previous();
+            auto parse_res = details::parse_delimited(str_value, delimiter_, escape_, target_);
+            if (!parse_res.first && first) {
+                // what vector held stays intact when the first value fails to parse
+                _restore_previous();
+            }
+            return parse_res;
+        }
+
+        std::optional<ValueType> val;
+        auto parse_res = parse_value(str_value, &val);
+
+        if (!parse_res.first) {
+            return parse_res;
+        }
+
+        _save_previous();
+        target_->emplace_back(std::move(*val));
+
+        return {true, std::string{}};
+    }
+
+    // see ArgumentList::set_delimiter()
+    void set_delimiter(char delimiter, char escape = '\0') {
+        delimiter_ = delimiter;
+        escape_ = escape;
+    }
+
+    char get_delimiter() const noexcept {
+        return delimiter_;
+    }
+
+    char get_escape() const noexcept {
+        return escape_;
+    }
+
+    bool has_value() const noexcept final {
+        return was_ || has_default_value();
+    }
+
+    // takes current content of the bound vector as default, empty vector means no default
+    void bind_default_value() {
+        if (target_->empty()) {
+            return;
+        }
+
+        if (was_) {
+            previous_ = *target_;
+        }
+        has_default_ = true;
+
+        std::ostringstream stream;
+        for (size_t idx = 0; idx < target_->size(); ++idx) {
+            stream << (idx != 0 ? " " : "") << (*target_)[idx];
+        }
+        default_text_ = stream.str();
+    }
+
+    bool is_many_values() const noexcept override {
+        return true;
+    }
+
+    details::ArgumentVariant typed_ref() noexcept final {
+        return details::make_node_variant<details::ArgumentVariant>(this);
+    }
+
+    void reset_to_default() noexcept final {
+        if (was_ && has_default_) {
+            _restore_previous();
+        } else if (!has_default_) {
+            target_->clear();
+        }
+        was_ = false;
+    }
+
+    bool save_state(details::StateWriter& out) const final {
+        if (!was_) {
+            return false;
+        }
+        out.values(*target_);
+        return true;
+    }
+
+    void restore_state(details::StateReader& in) final {
+        std::vector<ValueType> values;
+        in.values(&values);
+        _save_previous();
+        *target_ = std::move(values);
+    }
+
+private:
+    void _save_previous() noexcept {
+        if (!was_) {
+            previous_ = std::move(*target_);
+            target_->clear();
+            was_ = true;
+        }
+    }
+
+    void _restore_previous() noexcept {
+        *target_ = std::move(previous_);
+        previous_.clear();
+        was_ = false;
+    }
+
+private:
+    std::vector<ValueType>* target_;
+    bool was_ = false;
+    bool has_default_ = false;
+    char delimiter_ = '\0';
+    char escape_ = '\0';
+    // what vector held before the first parsed value
+    std::vector<ValueType> previous_;
+    std::string default_text_;
+};
+
 }  // namespace xdx::cliopts
@@ -1,22 +1,92 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <iterator>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace xdx::cliopts
 {
 
 class Argv
 {
+    template <class Range>
+    using EntryType = std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<const Range&>()))>>;
+
+    template <class Range>
+    using EnableIfRange = std::enable_if_t<std::is_convertible_v<const EntryType<Range>&, std::string_view>>;
+
 public:
+    // Entries are read through the view, so iterator yields std::string_view by value.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        Iterator(const Argv* argv, size_t idx)
+            : argv_{argv}
+            , idx_{idx} {
+        }
+
+        std::string_view operator*() const {
+            return (*argv_)[idx_];
+        }
+
+        Iterator& operator++() {
+            ++idx_;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator result(*this);
+            ++idx_;
+            return result;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return idx_ == other.idx_;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return idx_ != other.idx_;
+        }
+
+    private:
+        const Argv* argv_;
+        size_t idx_;
+    };
+
+    // Program name is skipped by offsetting the view, the caller's array is left untouched.
     Argv(int argc, const char** argv)
-        : cmd_{argv[0]}
-        , argc_(argc)
-        , argv_(argv) {
+        : cmd_{argc > 0 ? argv[0] : ""}
+        , argc_(argc > 0 ? argc - 1 : 0)
+        , argv_(argc > 0 ? argv + 1 : argv)
+        , entries_{argv_}
+        , get_{&_get<const char*>} {
+    }
 
-        shift_from(0);
+    // View over contiguous range of string_view convertible entries, e.g. std::vector<std::string>,
+    // the first one is program name. Entries are neither copied nor modified, the range must outlive
+    // the view and the result of parsing.
+    template <class Range, class = EnableIfRange<Range>>
+    Argv(const Range& range)
+        : cmd_{std::size(range) > 0 ? _get<EntryType<Range>>(std::data(range), 0) : std::string_view{}}
+        , argc_(std::size(range) > 0 ? static_cast<int>(std::size(range)) - 1 : 0)
+        , entries_{std::size(range) > 0 ? std::data(range) + 1 : std::data(range)}
+        , get_{&_get<EntryType<Range>>} {
     }
 
+    // results of parsing refer to entries, so temporary containers are refused
+    template <class Range, class = EnableIfRange<Range>, class = std::enable_if_t<!std::is_lvalue_reference_v<Range>>>
+    Argv(Range&& range) = delete;
+
     std::string_view cmd() const {
         return cmd_;
     }
@@ -29,36 +99,90 @@ public:
         return size() == 0;
     }
 
-    const char* operator[](size_t idx) {
+    std::string_view operator[](size_t idx) const {
         assert(idx < size());
-        return argv_[idx];
+        return _entry(idx);
     }
 
-    const char* const* begin() const {
-        return argv_;
+    Iterator begin() const {
+        return {this, 0};
     }
 
-    const char* const* end() const {
-        return argv_ + argc_;
+    Iterator end() const {
+        return {this, size()};
     }
 
-    void erase(size_t idx) {
-        shift_from(static_cast<int>(idx));
+    // View in which the first entry becomes command, e.g. `tool args` of `app tool args`.
+    Argv shifted() const {
+        assert(!empty());
+        Argv result(*this);
+        result.cmd_ = (*this)[0];
+        result.argc_ -= 1;
+        result.offset_ += 1;
+        if (result.argv_) {
+            result.argv_ += 1;
+        }
+        return result;
     }
 
-private:
-    void shift_from(int idx) {
-        for (int i = idx + 1; i < argc_; ++i) {
+    // Removes single entry by shifting the tail. Use compact() to drop many entries at once.
+    // Only views over argv array can be modified.
+    void erase(size_t idx) {
+        assert(idx < size());
+        assert(argv_ && "range views are read only");
+        for (int i = static_cast<int>(idx) + 1; i < argc_; ++i) {
             argv_[i - 1] = argv_[i];
         }
 
-        argc_ -= (idx + 1);
+        argc_ -= 1;
+    }
+
+    // Keeps entries for which `keep(idx)` is true, preserving their order, in a single pass.
+    template <class Predicate>
+    void compact(Predicate&& keep) {
+        assert(argv_ && "range views are read only");
+        int kept = 0;
+        for (int i = 0; i < argc_; ++i) {
+            if (keep(static_cast<size_t>(i))) {
+                argv_[kept++] = argv_[i];
+            }
+        }
+
+        argc_ = kept;
+    }
+
+private:
+    template <class Entry>
+    static std::string_view _get(const void* entries, size_t idx) {
+        return static_cast<const Entry*>(entries)[idx];
+    }
+
+    std::string_view _entry(size_t idx) const {
+        return get_(entries_, offset_ + idx);
     }
 
 private:
     std::string_view cmd_;
     int argc_;
-    const char** argv_;
+    // set only for views over argv array, which can be compacted
+    const char** argv_ = nullptr;
+    // type erased first entry of the range, read through get_
+    const void* entries_;
+    std::string_view (*get_)(const void* entries, size_t idx);
+    size_t offset_ = 0;
 };
 
+namespace details
+{
+
+// Splits NUL terminated entries of /proc/<pid>/cmdline format, terminator of the last one is optional.
+std::vector<std::string_view> split_cmdline(std::string_view buffer);
+
+}  // namespace details
+
+// Command line of the current process read from /proc/self/cmdline, for code which can't reach argv of main,
+// e.g. plugins. It is read once into a single buffer living until exit, entries are views into it.
+// Throws std::system_error when it can't be read.
+Argv self_argv();
+
 }  // namespace xdx::cliopts
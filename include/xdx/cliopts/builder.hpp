@@ -1,9 +1,13 @@
 #pragma once
 
 #include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/choice.hpp>
 #include <xdx/cliopts/flag.hpp>
 #include <xdx/cliopts/options.hpp>
 
+#include <initializer_list>
+#include <iterator>
+
 namespace xdx::cliopts
 {
 
@@ -66,6 +70,25 @@ inline constexpr std::string_view type_name() {
 
 }  // namespace details
 
+// Rows of tables for bulk registration, e.g. generated schemas. Either name can be empty.
+struct FlagSpec
+{
+    char short_name = '\0';
+    std::string_view long_name;
+    std::string_view description;
+    bool countable = false;
+};
+
+template <class Type>
+struct ArgumentSpec
+{
+    char short_name = '\0';
+    std::string_view long_name;
+    std::string_view description;
+    bool required = false;
+    std::string_view type_name = details::type_name<Type>();
+};
+
 class Builder
 {
 public:
@@ -73,6 +96,46 @@ public:
         : options_(std::make_shared<Options>(name, description)) {
     }
 
+    Builder& reserve(size_t flags, size_t arguments, size_t subcommands = 0) {
+        options_->reserve(flags, arguments, subcommands);
+        return *this;
+    }
+
+    // Registers all rows of `specs` after single reserve().
+    template <class Specs>
+    Builder& flags(const Specs& specs) {
+        options_->reserve(std::size(specs), 0);
+        for (const FlagSpec& spec : specs) {
+            if (spec.countable) {
+                options_->add(std::make_shared<FlagCount>(spec.short_name, spec.long_name, spec.description));
+            } else {
+                options_->add(std::make_shared<Flag>(spec.short_name, spec.long_name, spec.description));
+            }
+        }
+        return *this;
+    }
+
+    Builder& flags(std::initializer_list<FlagSpec> specs) {
+        return flags<std::initializer_list<FlagSpec>>(specs);
+    }
+
+    template <class Type, class Specs>
+    Builder& arguments(const Specs& specs) {
+        options_->reserve(0, std::size(specs));
+        for (const ArgumentSpec<Type>& spec : specs) {
+            auto argument = std::make_shared<Argument<Type>>(spec.short_name, spec.long_name, spec.description);
+            argument->set_required(spec.required);
+            argument->set_type_name(spec.type_name);
+            options_->add(argument);
+        }
+        return *this;
+    }
+
+    template <class Type>
+    Builder& arguments(std::initializer_list<ArgumentSpec<Type>> specs) {
+        return arguments<Type, std::initializer_list<ArgumentSpec<Type>>>(specs);
+    }
+
     Builder& flag(char short_name, std::string_view description) {
         options_->add(std::make_shared<Flag>(short_name, description));
         return *this;
@@ -229,16 +292,181 @@ public:
         return *this;
     }
 
+    Builder& flag(bool* target, char short_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlag>(target, short_name, description));
+        return *this;
+    }
+
+    Builder& flag(bool* target, std::string_view long_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlag>(target, long_name, description));
+        return *this;
+    }
+
+    Builder& flag(bool* target, char short_name, std::string_view long_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlag>(target, short_name, long_name, description));
+        return *this;
+    }
+
+    Builder& flag_count(size_t* target, char short_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlagCount>(target, short_name, description));
+        return *this;
+    }
+
+    Builder& flag_count(size_t* target, std::string_view long_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlagCount>(target, long_name, description));
+        return *this;
+    }
+
+    Builder& flag_count(size_t* target, char short_name, std::string_view long_name, std::string_view description) {
+        options_->add(std::make_shared<BoundFlagCount>(target, short_name, long_name, description));
+        return *this;
+    }
+
+    // Bound arguments write parsed values into `target`. Unless required, its current value is the default.
+    template <class Type>
+    Builder& argument(Type* target, std::string_view long_name, std::string_view description, bool required = false,
+                      std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgument<Type>>(target, long_name, description), required, type_name);
+    }
+
+    template <class Type>
+    Builder& argument(Type* target, char short_name, std::string_view description, bool required = false,
+                      std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgument<Type>>(target, short_name, description), required, type_name);
+    }
+
+    template <class Type>
+    Builder& argument(Type* target, char short_name, std::string_view long_name, std::string_view description,
+                      bool required = false, std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgument<Type>>(target, short_name, long_name, description), required,
+                         type_name);
+    }
+
+    template <class Type>
+    Builder& argument_list(std::vector<Type>* target, std::string_view long_name, std::string_view description,
+                           bool required = false, std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgumentList<Type>>(target, long_name, description), required,
+                         type_name);
+    }
+
+    template <class Type>
+    Builder& argument_list(std::vector<Type>* target, char short_name, std::string_view description,
+                           bool required = false, std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgumentList<Type>>(target, short_name, description), required,
+                         type_name);
+    }
+
+    template <class Type>
+    Builder& argument_list(std::vector<Type>* target, char short_name, std::string_view long_name,
+                           std::string_view description, bool required = false,
+                           std::string_view type_name = details::type_name<Type>()) {
+        return add_bound(std::make_shared<BoundArgumentList<Type>>(target, short_name, long_name, description),
+                         required, type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(std::string_view long_name, std::string_view description, ChoiceList<Enum> choices,
+                    bool required = true, std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(long_name, description, choices), required, type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(std::string_view long_name, std::string_view description, ChoiceList<Enum> choices,
+                    Enum default_value, std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(long_name, description, choices), default_value, type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(char short_name, std::string_view description, ChoiceList<Enum> choices, bool required = true,
+                    std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(short_name, description, choices), required, type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(char short_name, std::string_view description, ChoiceList<Enum> choices, Enum default_value,
+                    std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(short_name, description, choices), default_value, type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(char short_name, std::string_view long_name, std::string_view description,
+                    ChoiceList<Enum> choices, bool required = true, std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(short_name, long_name, description, choices), required,
+                          type_name);
+    }
+
+    template <class Enum>
+    Builder& choice(char short_name, std::string_view long_name, std::string_view description,
+                    ChoiceList<Enum> choices, Enum default_value, std::string_view type_name = CHOICE_TYPE_NAME) {
+        return add_choice(std::make_shared<Choice<Enum>>(short_name, long_name, description, choices), default_value,
+                          type_name);
+    }
+
+    // Constraints between flags and arguments added before, see Options::add_mutually_exclusive().
+    Builder& mutually_exclusive(std::initializer_list<std::string_view> names) {
+        options_->add_mutually_exclusive(names);
+        return *this;
+    }
+
+    Builder& depends_on(std::string_view name, std::initializer_list<std::string_view> names) {
+        options_->add_depends_on(name, names);
+        return *this;
+    }
+
+    Builder& at_least_one(std::initializer_list<std::string_view> names) {
+        options_->add_at_least_one(names);
+        return *this;
+    }
+
     Builder& add_subcommand(OptionsPtr subcommand) {
         options_->add(std::static_pointer_cast<iOptions>(subcommand));
         return *this;
     }
 
+    // `factory` is called only when the parser descends into subcommand or its own help is printed
+    Builder& add_subcommand(std::string_view name, std::string_view description, LazyOptions::Factory factory) {
+        options_->add(std::static_pointer_cast<iOptions>(
+            std::make_shared<LazyOptions>(name, description, std::move(factory))));
+        return *this;
+    }
+
     std::shared_ptr<Options> get_options() const noexcept {
         return options_;
     }
 
 private:
+    template <class Bound>
+    Builder& add_bound(const std::shared_ptr<Bound>& argument, bool required, std::string_view type_name) {
+        argument->set_required(required);
+        argument->set_type_name(type_name);
+        if (!required) {
+            argument->bind_default_value();
+        }
+        options_->add(argument);
+        return *this;
+    }
+
+    template <class Enum>
+    Builder& add_choice(const std::shared_ptr<Choice<Enum>>& argument, bool required, std::string_view type_name) {
+        argument->set_required(required);
+        argument->set_type_name(type_name);
+        options_->add(argument);
+        return *this;
+    }
+
+    template <class Enum>
+    Builder& add_choice(const std::shared_ptr<Choice<Enum>>& argument, Enum default_value,
+                        std::string_view type_name) {
+        argument->set_required(false);
+        argument->set_type_name(type_name);
+        argument->set_default_value(default_value);
+        options_->add(argument);
+        return *this;
+    }
+
+private:
+    static constexpr std::string_view CHOICE_TYPE_NAME = "CHOICE";
+
     std::shared_ptr<Options> options_;
 };
 
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+struct BulkConversionError
+{
+    size_t index = 0;
+    std::string message;
+};
+
+// Converts `texts[i]` into `values[i]` for every i in [0, count). Integers are parsed 8 digits per step,
+// doubles take exact fast path when mantissa and exponent are small enough. Everything else, including
+// errors, goes through the same scalar conversion as single values, so results and messages match it.
+// Failed elements are left untouched and reported in `errors` if it is given.
+// Returns number of converted elements.
+size_t convert_bulk(const std::string_view* texts, size_t count, int* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned int* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, long* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned long* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, long long* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned long long* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+size_t convert_bulk(const std::string_view* texts, size_t count, double* values,
+                    std::vector<BulkConversionError>* errors = nullptr);
+
+namespace details
+{
+
+template <class ValueType, class = void>
+struct HasBulkConversion : std::false_type
+{};
+
+template <class ValueType>
+struct HasBulkConversion<ValueType, std::void_t<decltype(convert_bulk(std::declval<const std::string_view*>(), 0,
+                                                                      std::declval<ValueType*>()))>>
+    : std::true_type
+{};
+
+template <class ValueType>
+inline constexpr bool has_bulk_conversion_v = HasBulkConversion<ValueType>::value;
+
+}  // namespace details
+
+}  // namespace xdx::cliopts
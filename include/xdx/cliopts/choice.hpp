@@ -0,0 +1,141 @@
+#pragma once
+
+#include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/details/perfect_hash.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+namespace xdx::cliopts
+{
+
+template <class Enum>
+using ChoiceList = std::initializer_list<std::pair<std::string_view, Enum>>;
+
+// Argument which value is one of fixed strings, each mapped to enum constant. Strings are resolved
+// through perfect hash built once from the list.
+template <class Enum>
+class Choice : public ArgumentBase
+{
+public:
+    Choice(const std::string_view& long_name, const std::string_view& description, ChoiceList<Enum> choices)
+        : ArgumentBase{long_name, description}
+        , names_{names_of(choices)}
+        , values_{values_of(choices)} {
+    }
+
+    Choice(char short_name, const std::string_view& description, ChoiceList<Enum> choices)
+        : ArgumentBase{short_name, description}
+        , names_{names_of(choices)}
+        , values_{values_of(choices)} {
+    }
+
+    Choice(char short_name, const std::string_view& long_name, const std::string_view& description,
+           ChoiceList<Enum> choices)
+        : ArgumentBase{short_name, long_name, description}
+        , names_{names_of(choices)}
+        , values_{values_of(choices)} {
+    }
+
+public:
+    std::string_view get_default_value() const final {
+        return default_index_ != details::PerfectHash::NPOS ? names_.key(default_index_) : std::string_view{};
+    }
+
+    bool has_default_value() const noexcept final {
+        return default_index_ != details::PerfectHash::NPOS;
+    }
+
+    std::pair<bool, std::string> set_string_value(const std::string_view& str_value) noexcept final {
+        const auto index = names_.find(str_value);
+        if (index == details::PerfectHash::NPOS) {
+            std::string message = "unexpected value '" + std::string(str_value) + "', expected one of: ";
+            for (size_t i = 0; i < names_.size(); ++i) {
+                message += i == 0 ? "" : ", ";
+                message += names_.key(i);
+            }
+            return {false, std::move(message)};
+        }
+        index_ = index;
+        return {true, {}};
+    }
+
+    bool has_value() const noexcept final {
+        return index_ != details::PerfectHash::NPOS || has_default_value();
+    }
+
+    // throws std::invalid_argument if `value` is not in the list
+    void set_default_value(Enum value) {
+        const auto it = std::find(values_.begin(), values_.end(), value);
+        if (it == values_.end()) {
+            throw std::invalid_argument("Default value is not one of choices");
+        }
+        default_index_ = static_cast<size_t>(it - values_.begin());
+    }
+
+    Enum get_value() const noexcept {
+        return values_[index_ != details::PerfectHash::NPOS ? index_ : default_index_];
+    }
+
+    bool is_many_values() const noexcept override {
+        return false;
+    }
+
+    void reset_to_default() noexcept final {
+        index_ = details::PerfectHash::NPOS;
+    }
+
+    // index of the choice is saved, so the value doesn't need to be resolved again
+    bool save_state(details::StateWriter& out) const final {
+        if (index_ == details::PerfectHash::NPOS) {
+            return false;
+        }
+        out.count(index_);
+        return true;
+    }
+
+    void restore_state(details::StateReader& in) final {
+        const auto index = in.count();
+        if (index >= names_.size()) {
+            throw std::invalid_argument("malformed state: wrong choice");
+        }
+        index_ = index;
+    }
+
+    size_t allowed_values_count() const noexcept override {
+        return names_.size();
+    }
+
+    std::string_view get_allowed_value(size_t idx) const noexcept override {
+        return names_.key(idx);
+    }
+
+private:
+    static std::vector<std::string_view> names_of(ChoiceList<Enum> choices) {
+        std::vector<std::string_view> names;
+        names.reserve(choices.size());
+        for (const auto& choice : choices) {
+            names.push_back(choice.first);
+        }
+        return names;
+    }
+
+    static std::vector<Enum> values_of(ChoiceList<Enum> choices) {
+        std::vector<Enum> values;
+        values.reserve(choices.size());
+        for (const auto& choice : choices) {
+            values.push_back(choice.second);
+        }
+        return values;
+    }
+
+private:
+    details::PerfectHash names_;
+    std::vector<Enum> values_;
+    size_t default_index_ = details::PerfectHash::NPOS;
+    size_t index_ = details::PerfectHash::NPOS;
+};
+
+}  // namespace xdx::cliopts
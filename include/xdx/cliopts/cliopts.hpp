@@ -3,7 +3,18 @@
 #include <xdx/cliopts/argument.hpp>
 #include <xdx/cliopts/argv.hpp>
 #include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/bulk_convert.hpp>
+#include <xdx/cliopts/choice.hpp>
+#include <xdx/cliopts/completion.hpp>
+#include <xdx/cliopts/diagnostic.hpp>
 #include <xdx/cliopts/flag.hpp>
+#include <xdx/cliopts/multi_call.hpp>
 #include <xdx/cliopts/options.hpp>
 #include <xdx/cliopts/parser.hpp>
 #include <xdx/cliopts/printer.hpp>
+#include <xdx/cliopts/record_reader.hpp>
+#include <xdx/cliopts/refs.hpp>
+#include <xdx/cliopts/schema.hpp>
+#include <xdx/cliopts/state.hpp>
+#include <xdx/cliopts/struct_binding.hpp>
+#include <xdx/cliopts/value_parser.hpp>
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <xdx/cliopts/argv.hpp>
+#include <xdx/cliopts/options.hpp>
+
+#include <iostream>
+#include <string_view>
+
+namespace xdx::cliopts
+{
+
+enum class Shell
+{
+    Bash,
+    Zsh,
+    Fish,
+};
+
+class Completer
+{
+public:
+    // hidden first argument which switches program into completion mode
+    static constexpr std::string_view COMMAND = "__complete";
+
+    Completer(const OptionsPtr& options)
+        : options_{options} {
+    }
+
+    // Walks already entered words without converting values or checking required arguments
+    // and prints one candidate per line for the word being completed.
+    void complete(Argv&& words, std::string_view partial, std::ostream& out);
+
+    // Prints script which delegates completion of `program` to `program __complete <words...>`.
+    void print_script(std::ostream& out, Shell shell, std::string_view program);
+
+private:
+    OptionsPtr options_;
+};
+
+// Handles `program __complete <words...> <partial>`. Returns false if argv is not a completion request.
+inline bool process_completion(const OptionsPtr& options, int argc, const char** argv, std::ostream& out = std::cout) {
+    if (argc < 2 || Completer::COMMAND != argv[1]) {
+        return false;
+    }
+
+    Completer completer(options);
+    const std::string_view partial = argc > 2 ? argv[argc - 1] : "";
+    completer.complete({argc > 2 ? argc - 2 : 1, argv + 1}, partial, out);
+    return true;
+}
+
+}  // namespace xdx::cliopts
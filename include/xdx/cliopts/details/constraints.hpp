@@ -0,0 +1,57 @@
+#pragma once
+
+#include <xdx/cliopts/details/node_bits.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+enum class ConstraintKind : uint8_t
+{
+    // at most one of `nodes`
+    MutuallyExclusive,
+    // all of `nodes` when `trigger` is given
+    Requires,
+    // at least one of `nodes`
+    AtLeastOne,
+};
+
+struct Constraint
+{
+    ConstraintKind kind;
+    NodeBits trigger;
+    NodeBits nodes;
+};
+
+// Relations between flags and arguments of single options node, checked against set of nodes given
+// on command line with a few word operations per constraint.
+class Constraints
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    void add(Constraint constraint) {
+        constraints_.push_back(std::move(constraint));
+    }
+
+    size_t size() const noexcept {
+        return constraints_.size();
+    }
+
+    const Constraint& get(size_t idx) const noexcept {
+        return constraints_[idx];
+    }
+
+    // index of first constraint at or after `from` violated by `provided`, NPOS if none
+    size_t find_violated(const NodeBits& provided, size_t from = 0) const noexcept;
+
+    void shrink_to_fit();
+
+private:
+    std::vector<Constraint> constraints_;
+};
+
+}  // namespace xdx::cliopts::details
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
 #include <optional>
 #include <sstream>
-#include <stdexcept>
 #include <string>
-#include <tuple>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 
 namespace xdx::cliopts::details
 {
 
+// Fallback for types which only have operator>>. Constructs stream per value.
 template <class ValueType>
 inline std::pair<bool, std::string> from_string(std::optional<ValueType>* result, const std::string& str) {
     std::istringstream stream{str};
@@ -24,148 +29,29 @@ inline std::pair<bool, std::string> from_string(std::optional<ValueType>* result
     return {true, std::string{}};
 }
 
-template <class Numeric, class ParseResult>
-inline Numeric parse_from_string(ParseResult (*func)(const std::string&, size_t*, int), const std::string& str) {
-    size_t pos;
-    ParseResult result = func(str, &pos, 10);
-    if (pos != str.size()) {
-        throw std::invalid_argument("unexpected trailing chars");
-    }
-
-    if (std::numeric_limits<Numeric>::max() < result) {
-        throw std::out_of_range("to big");
-    }
-
-    if (result < std::numeric_limits<Numeric>::min()) {
-        throw std::out_of_range("to small");
-    }
-
-    return static_cast<Numeric>(result);
-}
-
 template <class Numeric>
-inline Numeric parse_from_string(Numeric (*func)(const std::string&, size_t*), const std::string& str) {
-    size_t pos;
-    Numeric result = func(str, &pos);
-    if (pos != str.size()) {
-        throw std::invalid_argument("unexpected trailing chars");
+inline std::pair<bool, std::string> from_chars(std::optional<Numeric>* result, std::string_view str) {
+    // std::from_chars doesn't skip leading whitespace and doesn't accept explicit plus which stoi & co. did
+    str.remove_prefix(std::min(str.find_first_not_of(" \t\n\v\f\r"), str.size()));
+    if (str.size() > 1 && str.front() == '+' && str[1] != '-') {
+        str.remove_prefix(1);
     }
-    return static_cast<Numeric>(result);
-}
 
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<short>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<short>(std::stoi, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
+    Numeric value{};
+    const auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec == std::errc::result_out_of_range) {
+        return {false, "out of range"};
     }
-}
 
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<unsigned short>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<unsigned short>(std::stoul, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
+    if (ec != std::errc{} || str.empty()) {
+        return {false, "not a number"};
     }
-}
 
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<int>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<int>(std::stoi, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
+    if (end != str.data() + str.size()) {
+        return {false, "unexpected trailing chars"};
     }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<unsigned int>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<unsigned int>(std::stoul, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
 
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<long>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<long>(std::stol, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<unsigned long>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<unsigned long>(std::stoul, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<long long>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<long long>(std::stoll, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<unsigned long long>* result, const std::string& str) {
-    try {
-        *result = parse_from_string<unsigned long long>(std::stoull, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<float>* result, const std::string& str) {
-    try {
-        *result = parse_from_string(std::stof, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<double>* result, const std::string& str) {
-    try {
-        *result = parse_from_string(std::stod, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<long double>* result, const std::string& str) {
-    try {
-        *result = parse_from_string(std::stold, str);
-        return {true, std::string{}};
-    } catch (std::exception& ex) {
-        return {false, ex.what()};
-    }
-}
-
-template <>
-inline std::pair<bool, std::string> from_string(std::optional<std::string>* result, const std::string& str) {
-    *result = str;
+    *result = value;
     return {true, std::string{}};
 }
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+// Trie over names which resolves exact names and unique prefixes in O(length of name).
+// Nodes are kept in one contiguous array and updated by insert(), so lookups don't modify anything.
+// Children of a node are linked through siblings, names aren't stored and needn't outlive the trie.
+class NameTrie
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    struct Match
+    {
+        size_t count = 0;
+        size_t value = NPOS;
+    };
+
+    // inserting the same name again replaces its value
+    void insert(std::string_view name, size_t value);
+    // `count` names with `length` characters in total
+    void reserve(size_t count, size_t length = 0);
+    void shrink_to_fit();
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    // {1, value} for exact match, {0, NPOS} otherwise
+    Match find(std::string_view name) const noexcept;
+
+    // Exact match wins over longer names. Otherwise count is number of names starting with
+    // `prefix` and value is set only when there is exactly one of them. Empty prefix matches nothing.
+    Match find_prefix(std::string_view prefix) const noexcept;
+
+private:
+    static constexpr uint32_t NO_NODE = static_cast<uint32_t>(-1);
+
+    struct Node
+    {
+        uint32_t first_child = NO_NODE;
+        uint32_t next_sibling = NO_NODE;
+        // names which start with the path to the node
+        uint32_t names_count = 0;
+        unsigned char label = 0;
+        bool terminal = false;
+        // value of the node's name if terminal, otherwise of the last name inserted below
+        size_t value = NPOS;
+    };
+
+    uint32_t _child(uint32_t node, unsigned char label) const noexcept;
+    uint32_t _walk(std::string_view name) const noexcept;
+
+private:
+    // root is created by the first insert
+    std::vector<Node> nodes_;
+    size_t size_ = 0;
+};
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <xdx/cliopts/details/small_vector.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace xdx::cliopts::details
+{
+
+// Set of node table entries, one bit per entry. Set operations work on whole words, so checks over
+// any group of flags and arguments cost one operation per 64 entries. First 128 entries are stored in place,
+// so parser collects given nodes without allocations.
+class NodeBits
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    void set(size_t entry, bool value = true) {
+        while (entry / 64 >= words_.size()) {
+            words_.push_back(0);
+        }
+        const uint64_t bit = uint64_t{1} << (entry % 64);
+        words_[entry / 64] = value ? (words_[entry / 64] | bit) : (words_[entry / 64] & ~bit);
+    }
+
+    bool test(size_t entry) const noexcept {
+        return entry / 64 < words_.size() && ((words_[entry / 64] >> (entry % 64)) & 1) != 0;
+    }
+
+    // keeps storage, so bits could be collected again without allocations
+    void clear() noexcept {
+        std::fill(words_.begin(), words_.end(), 0);
+    }
+
+    void reserve(size_t entries) {
+        words_.reserve((entries + 63) / 64);
+    }
+
+    bool none() const noexcept {
+        return std::all_of(words_.begin(), words_.end(), [](uint64_t word) { return word == 0; });
+    }
+
+    bool intersects(const NodeBits& other) const noexcept {
+        const size_t count = std::min(words_.size(), other.words_.size());
+        for (size_t word = 0; word < count; ++word) {
+            if ((words_[word] & other.words_[word]) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // number of entries in both sets
+    size_t count_common(const NodeBits& other) const noexcept {
+        size_t result = 0;
+        const size_t count = std::min(words_.size(), other.words_.size());
+        for (size_t word = 0; word < count; ++word) {
+            result += popcount(words_[word] & other.words_[word]);
+        }
+        return result;
+    }
+
+    // first entry at or after `from`, NPOS if none
+    size_t find(size_t from = 0) const noexcept {
+        for (size_t word = from / 64; word < words_.size(); ++word) {
+            uint64_t bits = words_[word];
+            if (word == from / 64) {
+                bits &= ~uint64_t{0} << (from % 64);
+            }
+            if (bits != 0) {
+                return word * 64 + lowest_bit(bits);
+            }
+        }
+        return NPOS;
+    }
+
+    // first entry at or after `from` which is in this set and not in `other`, NPOS if none
+    size_t find_not_in(const NodeBits& other, size_t from = 0) const noexcept {
+        for (size_t word = from / 64; word < words_.size(); ++word) {
+            uint64_t bits = words_[word] & ~(word < other.words_.size() ? other.words_[word] : 0);
+            if (word == from / 64) {
+                bits &= ~uint64_t{0} << (from % 64);
+            }
+            if (bits != 0) {
+                return word * 64 + lowest_bit(bits);
+            }
+        }
+        return NPOS;
+    }
+
+    // first entry at or after `from` which is in both sets, NPOS if none
+    size_t find_in(const NodeBits& other, size_t from = 0) const noexcept {
+        const size_t count = std::min(words_.size(), other.words_.size());
+        for (size_t word = from / 64; word < count; ++word) {
+            uint64_t bits = words_[word] & other.words_[word];
+            if (word == from / 64) {
+                bits &= ~uint64_t{0} << (from % 64);
+            }
+            if (bits != 0) {
+                return word * 64 + lowest_bit(bits);
+            }
+        }
+        return NPOS;
+    }
+
+private:
+    static size_t lowest_bit(uint64_t bits) noexcept {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+        size_t result = 0;
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    static size_t popcount(uint64_t bits) noexcept {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_popcountll(bits));
+#else
+        size_t result = 0;
+        for (; bits != 0; bits &= bits - 1) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+private:
+    SmallVector<uint64_t, 2> words_;
+};
+
+}  // namespace xdx::cliopts::details
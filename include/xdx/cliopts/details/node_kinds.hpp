@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <variant>
+
+namespace xdx::cliopts
+{
+
+struct iFlag;
+class Flag;
+class FlagCount;
+class BoundFlag;
+class BoundFlagCount;
+
+struct iArgument;
+template <class ValueType>
+class Argument;
+template <class ValueType>
+class ArgumentList;
+template <class ValueType>
+class BoundArgument;
+template <class ValueType>
+class BoundArgumentList;
+
+namespace details
+{
+
+// Pointer to node of closed set of built-in kinds. Alternative 0 is the interface pointer, it holds
+// user implementations and is the null state.
+template <class Interface, class... Kinds>
+using NodeVariant = std::variant<Interface*, Kinds*...>;
+
+template <class... Types>
+using BuiltinArgumentVariant = NodeVariant<iArgument, Argument<Types>..., ArgumentList<Types>...,
+                                           BoundArgument<Types>..., BoundArgumentList<Types>...>;
+
+using ArgumentVariant =
+    BuiltinArgumentVariant<short, unsigned short, int, unsigned int, long, unsigned long, long long,
+                           unsigned long long, float, double, long double, std::string>;
+
+using FlagVariant = NodeVariant<iFlag, Flag, FlagCount, BoundFlag, BoundFlagCount>;
+
+template <class Kind, class Variant>
+struct IsNodeKind : std::false_type
+{
+};
+
+template <class Kind, class... Alternatives>
+struct IsNodeKind<Kind, std::variant<Alternatives...>> : std::disjunction<std::is_same<Kind*, Alternatives>...>
+{
+};
+
+// `node` as its own alternative, or as interface pointer if its kind isn't in the set, e.g. argument
+// of user defined value type.
+template <class Variant, class Kind>
+Variant make_node_variant(Kind* node) noexcept {
+    if constexpr (IsNodeKind<Kind, Variant>::value) {
+        return Variant{std::in_place_type<Kind*>, node};
+    } else {
+        return Variant{std::in_place_index<0>, node};
+    }
+}
+
+}  // namespace details
+
+}  // namespace xdx::cliopts
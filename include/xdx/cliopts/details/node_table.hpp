@@ -0,0 +1,78 @@
+#pragma once
+
+#include <xdx/cliopts/details/node_bits.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+enum class NodeKind : uint8_t
+{
+    Flag,
+    FlagCount,
+    Argument,
+    ArgumentList,
+};
+
+// Flags and arguments of single options node in structure-of-arrays form, so lookups, duplicate
+// checks and validation scan dense arrays instead of following pointer to every node.
+// Entries are kept in order of insertion, `index` refers to flags or arguments vector by kind.
+// Short names are few, at most one per char, so they are kept in a dense array scanned with memchr.
+// Long names are resolved through open addressing table over stored hashes, so registration of
+// N nodes with duplicate checks is O(N).
+class NodeTable
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    void add(NodeKind kind, size_t index, char short_name, std::string_view long_name, bool required);
+    void reserve(size_t count);
+    void shrink_to_fit();
+
+    size_t size() const noexcept;
+
+    // entry with the name or NPOS
+    size_t find(char short_name) const noexcept;
+    size_t find(std::string_view long_name) const noexcept;
+
+    NodeKind kind(size_t entry) const noexcept;
+    size_t index(size_t entry) const noexcept;
+    bool is_flag(size_t entry) const noexcept;
+
+    void set_required(size_t entry, bool required) noexcept;
+
+    // Points entry to equal copy of its long name, e.g. when strings are moved to other pool.
+    void move_name(size_t entry, std::string_view long_name) noexcept;
+
+    // argument indexes of required arguments, in order of insertion
+    std::vector<uint32_t> required_arguments() const;
+
+    const NodeBits& required() const noexcept {
+        return required_;
+    }
+
+    static uint32_t hash(std::string_view name) noexcept;
+
+private:
+    void rehash(size_t slots_count);
+    void insert_long(size_t entry);
+
+private:
+    std::vector<uint32_t> hashes_;
+    std::vector<uint32_t> lengths_;
+    std::vector<const char*> names_;
+    std::vector<NodeKind> kinds_;
+    std::vector<uint32_t> indexes_;
+    NodeBits required_;
+    // short names and their entries, in order of insertion
+    std::vector<char> short_names_;
+    std::vector<uint32_t> short_entries_;
+    // entry + 1 or zero for free slot, size is power of two
+    std::vector<uint32_t> long_slots_;
+    size_t long_names_count_ = 0;
+};
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+// Collision-free table over fixed set of keys, built with hash-and-displace: keys are grouped into
+// buckets by one hash, then every bucket gets seed of second hash which puts all its keys into free
+// slots. Lookup costs two hashes and single string comparison whatever the number of keys.
+class PerfectHash
+{
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    PerfectHash() = default;
+
+    // throws std::invalid_argument on duplicated keys
+    explicit PerfectHash(const std::vector<std::string_view>& keys);
+
+    // index of `key` in the list given to constructor or NPOS
+    size_t find(std::string_view key) const noexcept;
+
+    size_t size() const noexcept {
+        return keys_.size();
+    }
+
+    std::string_view key(size_t index) const noexcept {
+        return keys_[index];
+    }
+
+    size_t slots_count() const noexcept {
+        return slots_.size();
+    }
+
+private:
+    static uint32_t hash(std::string_view key, uint32_t seed) noexcept;
+    bool build(size_t slots_count);
+
+private:
+    std::vector<std::string> keys_;
+    // seed of second hash for every bucket
+    std::vector<uint32_t> seeds_;
+    // key index + 1, zero for free slot
+    std::vector<uint32_t> slots_;
+};
+
+}  // namespace xdx::cliopts::details
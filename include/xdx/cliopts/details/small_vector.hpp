@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace xdx::cliopts::details
+{
+
+// Vector which keeps first `InlineCapacity` elements in place and moves them to the heap
+// only when it grows beyond that. Limited to trivially copyable types such as string_view.
+template <class Type, size_t InlineCapacity>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable_v<Type> && std::is_trivially_destructible_v<Type>,
+                  "SmallVector supports only trivially copyable types");
+    static_assert(InlineCapacity > 0, "inline capacity can't be empty");
+
+public:
+    using value_type = Type;
+    using size_type = size_t;
+    using reference = Type&;
+    using const_reference = const Type&;
+    using iterator = Type*;
+    using const_iterator = const Type*;
+
+    SmallVector() noexcept = default;
+
+    SmallVector(std::initializer_list<Type> values) {
+        assign(values.begin(), values.size());
+    }
+
+    SmallVector(const SmallVector& other) {
+        assign(other.data(), other.size());
+    }
+
+    SmallVector(SmallVector&& other) noexcept {
+        steal(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            size_ = 0;
+            assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        release();
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // true while elements are kept in place
+    bool is_inline() const noexcept {
+        return data_ == inline_data();
+    }
+
+    Type* data() noexcept {
+        return data_;
+    }
+
+    const Type* data() const noexcept {
+        return data_;
+    }
+
+    iterator begin() noexcept {
+        return data_;
+    }
+
+    iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return data_;
+    }
+
+    const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    Type& operator[](size_t idx) noexcept {
+        assert(idx < size_);
+        return data_[idx];
+    }
+
+    const Type& operator[](size_t idx) const noexcept {
+        assert(idx < size_);
+        return data_[idx];
+    }
+
+    Type& front() noexcept {
+        return (*this)[0];
+    }
+
+    const Type& front() const noexcept {
+        return (*this)[0];
+    }
+
+    Type& back() noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    const Type& back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+
+        std::allocator<Type> allocator;
+        Type* data = allocator.allocate(capacity);
+        std::memcpy(static_cast<void*>(data), data_, size_ * sizeof(Type));
+        release();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void push_back(const Type& value) {
+        emplace_back(value);
+    }
+
+    template <class... Args>
+    Type& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // arguments may refer to own elements, which growing frees
+            Type value(std::forward<Args>(args)...);
+            reserve(capacity_ * 2);
+            return *new (data_ + size_++) Type(value);
+        }
+        return *new (data_ + size_++) Type(std::forward<Args>(args)...);
+    }
+
+    void pop_back() noexcept {
+        assert(size_ != 0);
+        size_ -= 1;
+    }
+
+    void clear() noexcept {
+        size_ = 0;
+    }
+
+    friend bool operator==(const SmallVector& lhs, const SmallVector& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend bool operator!=(const SmallVector& lhs, const SmallVector& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    Type* inline_data() noexcept {
+        return reinterpret_cast<Type*>(inline_);
+    }
+
+    const Type* inline_data() const noexcept {
+        return reinterpret_cast<const Type*>(inline_);
+    }
+
+    void assign(const Type* values, size_t count) {
+        reserve(count);
+        std::memcpy(static_cast<void*>(data_), values, count * sizeof(Type));
+        size_ = count;
+    }
+
+    void steal(SmallVector& other) noexcept {
+        if (other.is_inline()) {
+            data_ = inline_data();
+            capacity_ = InlineCapacity;
+            std::memcpy(static_cast<void*>(data_), other.data_, other.size_ * sizeof(Type));
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.capacity_ = InlineCapacity;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    void release() noexcept {
+        if (!is_inline()) {
+            std::allocator<Type>{}.deallocate(data_, capacity_);
+        }
+        data_ = inline_data();
+        capacity_ = InlineCapacity;
+    }
+
+private:
+    Type* data_ = inline_data();
+    size_t size_ = 0;
+    size_t capacity_ = InlineCapacity;
+    alignas(Type) unsigned char inline_[InlineCapacity * sizeof(Type)];
+};
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <xdx/cliopts/bulk_convert.hpp>
+#include <xdx/cliopts/value_parser.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+// Both are vectorized with SSE2 where it is available.
+size_t count_char(std::string_view text, char ch) noexcept;
+
+// Position of the first `first` or `second` at or after `from`, npos if there is none.
+size_t find_any(std::string_view text, size_t from, char first, char second) noexcept;
+
+// Calls `slice(std::string_view)` for every element of `text` separated by `delimiter` until it returns
+// false. `escape` followed by any char stands for that char, such elements are unescaped into `buffer`.
+// '\0' as `escape` disables escaping.
+template <class Callback>
+bool for_each_slice(std::string_view text, char delimiter, char escape, std::string& buffer, Callback&& slice) {
+    const char stop = escape != '\0' ? escape : delimiter;
+    size_t begin = 0;
+    bool escaped = false;
+    buffer.clear();
+
+    for (size_t pos = 0;;) {
+        const size_t found = find_any(text, pos, delimiter, stop);
+        if (found != text.npos && text[found] != delimiter) {
+            buffer.append(text.substr(begin, found - begin));
+            if (found + 1 < text.size()) {
+                buffer.push_back(text[found + 1]);
+            } else {
+                buffer.push_back(escape);
+            }
+            begin = pos = std::min(found + 2, text.size());
+            escaped = true;
+            continue;
+        }
+
+        auto piece = text.substr(begin, found == text.npos ? text.npos : found - begin);
+        if (escaped) {
+            buffer.append(piece);
+            piece = buffer;
+        }
+
+        if (!slice(piece) || found == text.npos) {
+            return found == text.npos;
+        }
+
+        buffer.clear();
+        escaped = false;
+        begin = pos = found + 1;
+    }
+}
+
+// Converts slices in batches through convert_bulk().
+template <class ValueType>
+std::pair<bool, std::string> parse_delimited_bulk(std::string_view text, char delimiter, char escape,
+                                                  std::vector<ValueType>* values) {
+    constexpr size_t BATCH_SIZE = 64;
+    std::string_view batch[BATCH_SIZE];
+    size_t batched = 0;
+
+    std::pair<bool, std::string> result{true, std::string{}};
+    std::vector<BulkConversionError> errors;
+    auto flush = [&]() {
+        const size_t offset = values->size();
+        values->resize(offset + batched);
+        convert_bulk(batch, batched, values->data() + offset, &errors);
+        batched = 0;
+        if (!errors.empty()) {
+            result = {false, std::move(errors.front().message)};
+            return false;
+        }
+        return true;
+    };
+
+    std::string buffer;
+    const bool completed = for_each_slice(text, delimiter, escape, buffer, [&](std::string_view slice) {
+        batch[batched++] = slice;
+        // unescaped slices live in the buffer which is reused by the next one
+        const bool borrowed = slice.data() < text.data() || slice.data() > text.data() + text.size();
+        return (batched < BATCH_SIZE && !borrowed) || flush();
+    });
+
+    if (completed && batched != 0) {
+        flush();
+    }
+    return result;
+}
+
+// Appends all converted elements of `text` to `values`. On error `values` is left as it was.
+template <class ValueType>
+std::pair<bool, std::string> parse_delimited(std::string_view text, char delimiter, char escape,
+                                             std::vector<ValueType>* values) {
+    const size_t initial_size = values->size();
+    // grows geometrically, so many occurrences of one argument don't reallocate on each
+    const size_t needed = initial_size + count_char(text, delimiter) + 1;
+    if (values->capacity() < needed) {
+        values->reserve(std::max(2 * values->capacity(), needed));
+    }
+
+    if constexpr (has_bulk_conversion_v<ValueType>) {
+        auto result = parse_delimited_bulk(text, delimiter, escape, values);
+        if (!result.first) {
+            values->erase(values->begin() + initial_size, values->end());
+        }
+        return result;
+    }
+
+    std::pair<bool, std::string> result{true, std::string{}};
+    std::optional<ValueType> value;
+    std::string buffer;
+    for_each_slice(text, delimiter, escape, buffer, [&](std::string_view slice) {
+        result = parse_value(slice, &value);
+        if (!result.first) {
+            return false;
+        }
+        values->emplace_back(std::move(*value));
+        return true;
+    });
+
+    if (!result.first) {
+        values->erase(values->begin() + initial_size, values->end());
+    }
+    return result;
+}
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <xdx/cliopts/value_parser.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+// Values of parsed state, see serialize_state(). Counts are uint32_t in host byte order, trivially copyable
+// values are copied as bytes, strings are length prefixed and other types are kept as text.
+class StateWriter
+{
+public:
+    explicit StateWriter(std::string& out)
+        : out_{out} {
+    }
+
+    void count(size_t value) {
+        const auto count = static_cast<uint32_t>(value);
+        out_.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+
+    void string(std::string_view value) {
+        count(value.size());
+        out_.append(value);
+    }
+
+    template <class ValueType>
+    void value(const ValueType& value) {
+        if constexpr (std::is_same_v<ValueType, std::string>) {
+            string(value);
+        } else if constexpr (std::is_trivially_copyable_v<ValueType>) {
+            out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            string(stream.str());
+        }
+    }
+
+    template <class ValueType>
+    void values(const std::vector<ValueType>& values) {
+        count(values.size());
+        for (const auto& value : values) {
+            this->value(value);
+        }
+    }
+
+private:
+    std::string& out_;
+};
+
+// Throws std::invalid_argument when input is truncated or holds a value which can't be restored.
+class StateReader
+{
+public:
+    explicit StateReader(std::string_view in)
+        : in_{in} {
+    }
+
+    bool at_end() const noexcept {
+        return in_.empty();
+    }
+
+    size_t count() {
+        uint32_t count = 0;
+        std::memcpy(&count, _take(sizeof(count)), sizeof(count));
+        return count;
+    }
+
+    std::string_view string() {
+        const auto size = count();
+        return {_take(size), size};
+    }
+
+    template <class ValueType>
+    ValueType value() {
+        if constexpr (std::is_same_v<ValueType, std::string>) {
+            return std::string(string());
+        } else if constexpr (std::is_trivially_copyable_v<ValueType>) {
+            ValueType value;
+            std::memcpy(static_cast<void*>(&value), _take(sizeof(value)), sizeof(value));
+            return value;
+        } else {
+            std::optional<ValueType> value;
+            if (!parse_value(string(), &value).first) {
+                throw std::invalid_argument("malformed state: wrong value");
+            }
+            return std::move(*value);
+        }
+    }
+
+    template <class ValueType>
+    void values(std::vector<ValueType>* values) {
+        const auto size = count();
+        // every value takes at least its size or its length prefix, so count can't exceed what's left
+        constexpr bool prefixed = std::is_same_v<ValueType, std::string> || !std::is_trivially_copyable_v<ValueType>;
+        constexpr size_t min_size = prefixed ? sizeof(uint32_t) : sizeof(ValueType);
+        if (size > in_.size() / min_size) {
+            throw std::invalid_argument("malformed state: truncated");
+        }
+        values->clear();
+        values->reserve(size);
+        for (size_t idx = 0; idx < size; ++idx) {
+            values->push_back(value<ValueType>());
+        }
+    }
+
+private:
+    const char* _take(size_t size) {
+        if (size > in_.size()) {
+            throw std::invalid_argument("malformed state: truncated");
+        }
+        const char* data = in_.data();
+        in_.remove_prefix(size);
+        return data;
+    }
+
+    std::string_view in_;
+};
+
+}  // namespace xdx::cliopts::details
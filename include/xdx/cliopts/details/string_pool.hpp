@@ -0,0 +1,84 @@
+#pragma once
+
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace xdx::cliopts::details
+{
+
+// Append-only storage of names and descriptions shared by whole options tree. Strings are packed
+// into large chunks, so views stay valid while pool is alive, and equal strings are stored once.
+// Lookup is a flat open addressing table of views into chunks, so interning allocates only when
+// a chunk is filled or the table grows.
+class StringPool
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::string_view intern(std::string_view str);
+
+    // number of distinct strings
+    size_t size() const noexcept;
+
+    // bytes taken by strings, chunks may have unused tail
+    size_t bytes_used() const noexcept;
+
+    size_t chunks_count() const noexcept;
+
+private:
+    char* allocate(size_t size);
+    // slot holding `str` or empty slot where it belongs
+    std::string_view& _slot(std::string_view str) noexcept;
+    void _grow();
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* cursor_ = nullptr;
+    size_t left_ = 0;
+    size_t used_ = 0;
+    // power of two sized, empty views are free slots since empty strings aren't stored
+    std::vector<std::string_view> slots_;
+    size_t size_ = 0;
+};
+
+using StringPoolPtr = std::shared_ptr<StringPool>;
+
+// Copies `views` into single buffer owned by result and points them there. Used by nodes created
+// outside of options tree until they are moved into tree's pool. Nothing is allocated if all views are empty.
+std::unique_ptr<char[]> own_strings(std::initializer_list<std::string_view*> views);
+
+// Points `views` into `pool`.
+void intern_strings(StringPool& pool, std::initializer_list<std::string_view*> views);
+
+// Keeps strings of single flag or argument alive: in own buffer until node is added to options,
+// in the options' pool afterwards.
+class NodeStrings
+{
+public:
+    // `views` must list all strings of the node, they are copied again on every call
+    void own(std::initializer_list<std::string_view*> views) {
+        if (pool_) {
+            intern_strings(*pool_, views);
+        } else {
+            buffer_ = own_strings(views);
+        }
+    }
+
+    void attach(const StringPoolPtr& pool, std::initializer_list<std::string_view*> views) {
+        intern_strings(*pool, views);
+        pool_ = pool;
+        buffer_.reset();
+    }
+
+private:
+    StringPoolPtr pool_;
+    std::unique_ptr<char[]> buffer_;
+};
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <xdx/cliopts/error.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+enum class DiagnosticId : uint8_t
+{
+    ExpectedValue,
+    UnknownSwitcher,
+    AmbiguousSwitcher,
+    WrongValue,
+    AmbiguousSubcommand,
+    RequiredArgument,
+    MutuallyExclusive,
+    MissingDependency,
+    AtLeastOneRequired,
+    UnknownTool,
+};
+
+// Single parsing error. Parser collects them into result and renders text only if asked to.
+struct Diagnostic
+{
+    static constexpr size_t NO_ARGV_INDEX = static_cast<size_t>(-1);
+
+    DiagnosticId id;
+    std::error_code error;
+    // index in argv without program name, NO_ARGV_INDEX for errors found after the whole node is parsed
+    size_t argv_index = NO_ARGV_INDEX;
+    // switcher as it's written, e.g. `--jobs` or `-j`, or subcommand name
+    std::string name;
+    // value conversion error of WrongValue
+    std::string message;
+    // candidates of ambiguous names, switchers of violated constraint
+    std::vector<std::string> related;
+};
+
+using Diagnostics = std::vector<Diagnostic>;
+
+namespace details
+{
+
+// flag or argument as it's written on command line, long name is preferred
+template <class Source>
+std::string switcher_name(const Source& source) {
+    if (!source->get_long_name().empty()) {
+        return "--" + std::string(source->get_long_name());
+    }
+    return std::string("-") + source->get_short_name();
+}
+
+}  // namespace details
+
+// One line per diagnostic.
+void render(std::string& out, const Diagnostic& diagnostic);
+std::string render(const Diagnostics& diagnostics);
+
+// Renders all diagnostics into one buffer and writes it with single call.
+void write_diagnostics(std::ostream& out, const Diagnostics& diagnostics);
+
+}  // namespace xdx::cliopts
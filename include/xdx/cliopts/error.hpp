@@ -12,6 +12,11 @@ enum class ProcessingArgumentsError : int
     WrongValueType = 3,
     UnknownSubcommand = 4,
     RequiredArgument = 5,
+    AmbiguousSubcommand = 6,
+    AmbiguousSwitcher = 7,
+    MutuallyExclusive = 8,
+    MissingDependency = 9,
+    AtLeastOneRequired = 10,
 };
 
 class ProcessingArgumentsErrorCategory : public std::error_category
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <xdx/cliopts/details/node_kinds.hpp>
+#include <xdx/cliopts/details/string_pool.hpp>
+
 #include <string>
 #include <string_view>
 
@@ -16,6 +19,28 @@ struct iFlag
     virtual void set_found() noexcept = 0;
     virtual bool is_set() const noexcept = 0;
     virtual void reset_to_default() noexcept = 0;
+
+    // Number of occurrences, flags which aren't countable give 1 once set.
+    virtual size_t get_count() const noexcept {
+        return is_set() ? 1 : 0;
+    }
+
+    // Makes the flag look found `count` times since reset, e.g. when state is restored.
+    virtual void set_count(size_t count) noexcept {
+        reset_to_default();
+        for (size_t n = 0; n < count; ++n) {
+            set_found();
+        }
+    }
+
+    // Moves names into pool of options the flag is added to. Flags which don't own strings ignore it.
+    virtual void attach_strings(const details::StringPoolPtr& /*pool*/) {
+    }
+
+    // Built-in kinds return themselves, so FlagRef calls their final overrides directly.
+    virtual details::FlagVariant typed_ref() noexcept {
+        return details::FlagVariant{std::in_place_index<0>, this};
+    }
 };
 
 class FlagBase : public iFlag
@@ -28,12 +53,14 @@ public:
     char get_short_name() const noexcept override;
     std::string_view get_long_name() const noexcept override;
     std::string_view get_description() const noexcept override;
+    void attach_strings(const details::StringPoolPtr& pool) override;
 
 private:
     char short_name_ = '\0';
     bool is_required_ = false;
-    std::string long_name_;
-    std::string description_;
+    std::string_view long_name_;
+    std::string_view description_;
+    details::NodeStrings strings_;
 };
 
 class Flag : public FlagBase
@@ -44,7 +71,9 @@ public:
     Flag(char short_name, const std::string_view& long_name, const std::string_view& description);
 
     void set_found() noexcept final;
+    void set_count(size_t count) noexcept final;
     bool is_set() const noexcept final;
+    details::FlagVariant typed_ref() noexcept final;
     void reset_to_default() noexcept final;
 
     bool is_countable() const noexcept {
@@ -62,8 +91,10 @@ public:
     FlagCount(char short_name, const std::string_view& description);
     FlagCount(char short_name, const std::string_view& long_name, const std::string_view& description);
     void set_found() noexcept final;
+    void set_count(size_t count) noexcept final;
     bool is_set() const noexcept final;
-    size_t get_count() const noexcept;
+    details::FlagVariant typed_ref() noexcept final;
+    size_t get_count() const noexcept final;
     void reset_to_default() noexcept final;
 
     bool is_countable() const noexcept {
@@ -74,4 +105,54 @@ private:
     size_t was_ = 0;
 };
 
+// Writes `true` into caller owned variable when found. Variable is restored by reset_to_default().
+class BoundFlag : public FlagBase
+{
+public:
+    BoundFlag(bool* target, const std::string_view& long_name, const std::string_view& description);
+    BoundFlag(bool* target, char short_name, const std::string_view& description);
+    BoundFlag(bool* target, char short_name, const std::string_view& long_name, const std::string_view& description);
+
+    void set_found() noexcept final;
+    void set_count(size_t count) noexcept final;
+    bool is_set() const noexcept final;
+    details::FlagVariant typed_ref() noexcept final;
+    void reset_to_default() noexcept final;
+
+    bool is_countable() const noexcept {
+        return false;
+    }
+
+private:
+    bool* target_;
+    bool default_;
+    bool was_ = false;
+};
+
+// Increments caller owned counter on every occurrence.
+class BoundFlagCount : public FlagBase
+{
+public:
+    BoundFlagCount(size_t* target, const std::string_view& long_name, const std::string_view& description);
+    BoundFlagCount(size_t* target, char short_name, const std::string_view& description);
+    BoundFlagCount(size_t* target, char short_name, const std::string_view& long_name,
+                   const std::string_view& description);
+
+    void set_found() noexcept final;
+    void set_count(size_t count) noexcept final;
+    bool is_set() const noexcept final;
+    details::FlagVariant typed_ref() noexcept final;
+    size_t get_count() const noexcept final;
+    void reset_to_default() noexcept final;
+
+    bool is_countable() const noexcept {
+        return true;
+    }
+
+private:
+    size_t* target_;
+    size_t default_;
+    bool was_ = false;
+};
+
 }  // namespace xdx::cliopts
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <xdx/cliopts/argv.hpp>
+#include <xdx/cliopts/options.hpp>
+#include <xdx/cliopts/parser.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+// Busybox-style single binary which acts as one of its tools. Tool is chosen by basename of argv[0],
+// e.g. through `ln -s app ls`, or by the first argument when binary is called by its own name,
+// `app ls -l`. Only options of the chosen tool are built.
+class MultiCall
+{
+public:
+    using Factory = LazyOptions::Factory;
+
+    struct Selection
+    {
+        // nullptr if no tool matches
+        OptionsPtr tool;
+        // arguments of the tool, its name is cmd()
+        Argv argv;
+    };
+
+    struct Result
+    {
+        OptionsPtr tool;
+        Parser::ProcessResult parsed;
+    };
+
+    explicit MultiCall(std::string_view name);
+
+    // throws std::invalid_argument for empty or duplicated names
+    MultiCall& add_tool(std::string_view name, std::string_view description, Factory factory);
+
+    std::string_view get_name() const noexcept {
+        return name_;
+    }
+
+    size_t tools_count() const noexcept {
+        return tools_.size();
+    }
+
+    const std::shared_ptr<LazyOptions>& get_tool(size_t idx) const noexcept {
+        return tools_[idx];
+    }
+
+    // nullptr for unknown name, the tool isn't built by lookup
+    std::shared_ptr<LazyOptions> find_tool(std::string_view name) const noexcept;
+
+    Selection select(const Argv& argv) const;
+
+    // Selects tool and parses the rest of argv with its options by `parser` rebound to the tool, so its
+    // settings apply and options it was created with are ignored. Unknown tool is reported as
+    // UnknownSubcommand. Diagnostics are returned and written to `errout` only if `parser` writes them.
+    Result process(Argv&& argv, const Parser& parser, std::ostream& errout = std::cerr) const;
+
+    // same with default Parser settings
+    Result process(Argv&& argv, std::ostream& errout = std::cerr) const;
+
+    // `dir/name` and `dir\name` give `name`
+    static std::string_view basename(std::string_view path) noexcept;
+
+private:
+    std::string name_;
+    std::vector<std::shared_ptr<LazyOptions>> tools_;
+    // keys are names kept by tools
+    std::unordered_map<std::string_view, size_t> index_;
+};
+
+}  // namespace xdx::cliopts
@@ -1,6 +1,21 @@
 #pragma once
 
+#include <xdx/cliopts/details/constraints.hpp>
+#include <xdx/cliopts/details/name_trie.hpp>
+#include <xdx/cliopts/details/node_table.hpp>
+#include <xdx/cliopts/details/string_pool.hpp>
+#include <xdx/cliopts/diagnostic.hpp>
+#include <xdx/cliopts/refs.hpp>
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 namespace xdx::cliopts
@@ -16,6 +31,9 @@ class Argument;
 template <class Type>
 class ArgumentList;
 
+template <class Enum>
+class Choice;
+
 struct iOptions
 {
     using FlagPtr = std::shared_ptr<iFlag>;
@@ -26,50 +44,89 @@ struct iOptions
     using TypedArgumentPtr = std::shared_ptr<Argument<Type>>;
     template <class Type>
     using TypedArgumentListPtr = std::shared_ptr<ArgumentList<Type>>;
+    template <class Enum>
+    using ChoicePtr = std::shared_ptr<Choice<Enum>>;
     // using ArgumentListPtr = std::shared_ptr<ArgumentList>;
 
     virtual ~iOptions() = default;
     virtual std::string_view get_name() const noexcept = 0;
     virtual std::string_view get_description() const noexcept = 0;
 
-    virtual size_t flags_count() const noexcept = 0;
-    virtual size_t arguments_count() const noexcept = 0;
-    virtual size_t subcommands_count() const noexcept = 0;
+    virtual size_t flags_count() const = 0;
+    virtual size_t arguments_count() const = 0;
+    virtual size_t subcommands_count() const = 0;
+
+    virtual FlagPtr get_flag(size_t idx) const = 0;
+    virtual ArgumentPtr get_argument(size_t idx) const = 0;
+    virtual SubcommandPtr get_subcommand(size_t idx) const = 0;
 
-    virtual FlagPtr get_flag(size_t idx) const noexcept = 0;
-    virtual ArgumentPtr get_argument(size_t idx) const noexcept = 0;
-    virtual SubcommandPtr get_subcommand(size_t idx) const noexcept = 0;
+    virtual FlagPtr find_flag(char short_name) const = 0;
+    virtual FlagPtr find_flag(std::string_view long_name) const = 0;
 
-    virtual FlagPtr find_flag(char short_name) const noexcept = 0;
-    virtual FlagPtr find_flag(std::string_view long_name) const noexcept = 0;
+    virtual FlagCountPtr find_flag_count(char short_name) const = 0;
+    virtual FlagCountPtr find_flag_count(std::string_view long_name) const = 0;
 
-    virtual FlagCountPtr find_flag_count(char short_name) const noexcept = 0;
-    virtual FlagCountPtr find_flag_count(std::string_view long_name) const noexcept = 0;
+    virtual ArgumentPtr find_argument(char short_name) const = 0;
+    virtual ArgumentPtr find_argument(std::string_view long_name) const = 0;
 
-    virtual ArgumentPtr find_argument(char short_name) const noexcept = 0;
-    virtual ArgumentPtr find_argument(std::string_view long_name) const noexcept = 0;
+    // Resolves unique prefix of long name among both flags and arguments. Exact name wins over longer
+    // names. Returns number of matched names and the flag or the argument when it is the only one.
+    virtual std::tuple<size_t, FlagPtr, ArgumentPtr> find_long_name_prefix(std::string_view prefix) const = 0;
 
     template <class Type>
-    TypedArgumentPtr<Type> find_typed_argument(char short_name) const noexcept {
+    TypedArgumentPtr<Type> find_typed_argument(char short_name) const {
         return std::dynamic_pointer_cast<Argument<Type>>(find_argument(short_name));
     }
 
     template <class Type>
-    TypedArgumentPtr<Type> find_typed_argument(std::string_view long_name) const noexcept {
+    TypedArgumentPtr<Type> find_typed_argument(std::string_view long_name) const {
         return std::dynamic_pointer_cast<Argument<Type>>(find_argument(long_name));
     }
 
     template <class Type>
-    TypedArgumentListPtr<Type> find_typed_argument_list(char short_name) const noexcept {
+    TypedArgumentListPtr<Type> find_typed_argument_list(char short_name) const {
         return std::dynamic_pointer_cast<ArgumentList<Type>>(find_argument(short_name));
     }
 
     template <class Type>
-    TypedArgumentListPtr<Type> find_typed_argument_list(std::string_view long_name) const noexcept {
+    TypedArgumentListPtr<Type> find_typed_argument_list(std::string_view long_name) const {
         return std::dynamic_pointer_cast<ArgumentList<Type>>(find_argument(long_name));
     }
 
-    virtual SubcommandPtr find_subcommand(std::string_view name) const noexcept = 0;
+    template <class Enum>
+    ChoicePtr<Enum> find_choice(char short_name) const {
+        return std::dynamic_pointer_cast<Choice<Enum>>(find_argument(short_name));
+    }
+
+    template <class Enum>
+    ChoicePtr<Enum> find_choice(std::string_view long_name) const {
+        return std::dynamic_pointer_cast<Choice<Enum>>(find_argument(long_name));
+    }
+
+    virtual SubcommandPtr find_subcommand(std::string_view name) const = 0;
+
+    // Exact name wins over longer names. Otherwise returns number of subcommands which names start
+    // with `prefix` and the subcommand itself when it is the only one.
+    virtual std::pair<size_t, SubcommandPtr> find_subcommand_prefix(std::string_view prefix) const = 0;
+
+    // Closed-set views the parser dispatches on. Defaults wrap find_*() results, so every call
+    // on them stays virtual; Options resolves built-in kinds once, when they are added.
+    virtual FlagRef find_flag_ref(char short_name) const;
+    virtual FlagRef find_flag_ref(std::string_view long_name) const;
+    virtual ArgumentRef find_argument_ref(char short_name) const;
+    virtual ArgumentRef find_argument_ref(std::string_view long_name) const;
+    virtual ArgumentRef get_argument_ref(size_t idx) const;
+
+    // Index of the first required argument at or after `from` which has no value, arguments_count() if none.
+    virtual size_t find_missing_required(size_t from) const;
+
+    // Checks required arguments and constraints once the node is parsed. `provided` has bit of every node
+    // table entry given on command line. Violations are appended to `diagnostics`, the first one is returned.
+    virtual std::error_code check_provided(const details::NodeBits& provided, Diagnostics& diagnostics) const;
+
+    // Freezes options into layout optimized for lookups, nothing can be added afterwards.
+    virtual void compile() {
+    }
 
     virtual void add(FlagPtr&& flag) = 0;
     virtual void add(ArgumentPtr&& arg) = 0;
@@ -95,29 +152,136 @@ public:
     void add(ArgumentPtr&& arg) override;
     void add(SubcommandPtr&& sub) override;
 
+    // Reserves storage for that many more nodes, so bulk registration doesn't reallocate.
+    void reserve(size_t flags, size_t arguments, size_t subcommands = 0);
+
     FlagPtr find_flag(char short_name) const noexcept override;
     FlagPtr find_flag(std::string_view long_name) const noexcept override;
     FlagCountPtr find_flag_count(char short_name) const noexcept override;
     FlagCountPtr find_flag_count(std::string_view long_name) const noexcept override;
     ArgumentPtr find_argument(char short_name) const noexcept override;
     ArgumentPtr find_argument(std::string_view long_name) const noexcept override;
+    std::tuple<size_t, FlagPtr, ArgumentPtr> find_long_name_prefix(std::string_view prefix) const override;
     SubcommandPtr find_subcommand(std::string_view name) const noexcept override;
+    std::pair<size_t, SubcommandPtr> find_subcommand_prefix(std::string_view prefix) const noexcept override;
+    FlagRef find_flag_ref(char short_name) const noexcept override;
+    FlagRef find_flag_ref(std::string_view long_name) const noexcept override;
+    ArgumentRef find_argument_ref(char short_name) const noexcept override;
+    ArgumentRef find_argument_ref(std::string_view long_name) const noexcept override;
+    ArgumentRef get_argument_ref(size_t idx) const noexcept override;
+    size_t find_missing_required(size_t from) const noexcept override;
+    std::error_code check_provided(const details::NodeBits& provided, Diagnostics& diagnostics) const override;
+
+    // Constraints refer to flags and arguments added before by long name or by short name given as
+    // single char. Throw std::invalid_argument for unknown names.
+    void add_mutually_exclusive(std::initializer_list<std::string_view> names);
+    void add_depends_on(std::string_view name, std::initializer_list<std::string_view> names);
+    void add_at_least_one(std::initializer_list<std::string_view> names);
 
     void reset_to_default() noexcept override;
 
+    // Builds lookup indexes and required arguments list, compiles subcommands. add() throws afterwards.
+    void compile() override;
+    bool is_compiled() const noexcept;
+
+    // Pool which keeps name, description and strings of all added flags and arguments. It is created by
+    // every node and replaced by the parent's one when node is added as subcommand, so whole tree of
+    // Options shares single pool.
+    const details::StringPoolPtr& get_strings() const noexcept;
+
 private:
+    void _assert_not_compiled();
     void _assert_short_name(char ch);
     void _assert_long_name(const std::string_view& lname);
     void _assert_sub_name(const std::string_view& name);
+    size_t _find_node(std::string_view name) const;
+    details::NodeBits _find_nodes(std::initializer_list<std::string_view> names) const;
+    std::string _node_name(size_t entry) const;
+    std::vector<std::string> _node_names(const details::NodeBits& nodes) const;
+    void _share_strings(const details::StringPoolPtr& pool);
+    const details::NameTrie& _long_names_index() const;
 
 private:
+    details::StringPoolPtr strings_;
     std::string_view name_;
     std::string_view description_;
     std::vector<FlagPtr> flags_;
     std::vector<ArgumentPtr> arguments_;
     std::vector<SubcommandPtr> subcommands_;
+    std::vector<FlagRef> flag_refs_;
+    std::vector<ArgumentRef> argument_refs_;
+    details::NodeTable nodes_;
+    std::vector<uint32_t> required_arguments_;
+    details::Constraints constraints_;
+    bool compiled_ = false;
+    // Exact long names are resolved by nodes_, this index serves abbreviations only. It is built by the
+    // first prefix lookup and kept up to date afterwards. Flag `i` is stored as `2 * i`, argument `i`
+    // as `2 * i + 1`.
+    mutable details::NameTrie long_names_index_;
+    mutable std::once_flag long_names_once_;
+    mutable std::atomic<bool> long_names_indexed_{false};
+    details::NameTrie subcommands_index_;
+    // duplicate check of subcommand names, released by compile()
+    std::unordered_set<std::string_view> subcommand_names_;
 };
 
 using OptionsPtr = std::shared_ptr<iOptions>;
 
+// Subcommand which builds its options only when something beyond name and description is requested.
+// Exceptions of the factory propagate from the call which requested options, that's why lookups of
+// iOptions aren't noexcept.
+class LazyOptions : public iOptions
+{
+public:
+    using Factory = std::function<OptionsPtr()>;
+
+    LazyOptions(const std::string_view& name, const std::string_view& description, Factory factory);
+    ~LazyOptions() = default;
+    std::string_view get_name() const noexcept override;
+    std::string_view get_description() const noexcept override;
+    size_t flags_count() const override;
+    size_t arguments_count() const override;
+    size_t subcommands_count() const override;
+    FlagPtr get_flag(size_t idx) const override;
+    ArgumentPtr get_argument(size_t idx) const override;
+    SubcommandPtr get_subcommand(size_t idx) const override;
+    void add(FlagPtr&& flag) override;
+    void add(ArgumentPtr&& arg) override;
+    void add(SubcommandPtr&& sub) override;
+
+    FlagPtr find_flag(char short_name) const override;
+    FlagPtr find_flag(std::string_view long_name) const override;
+    FlagCountPtr find_flag_count(char short_name) const override;
+    FlagCountPtr find_flag_count(std::string_view long_name) const override;
+    ArgumentPtr find_argument(char short_name) const override;
+    ArgumentPtr find_argument(std::string_view long_name) const override;
+    std::tuple<size_t, FlagPtr, ArgumentPtr> find_long_name_prefix(std::string_view prefix) const override;
+    SubcommandPtr find_subcommand(std::string_view name) const override;
+    std::pair<size_t, SubcommandPtr> find_subcommand_prefix(std::string_view prefix) const override;
+    FlagRef find_flag_ref(char short_name) const override;
+    FlagRef find_flag_ref(std::string_view long_name) const override;
+    ArgumentRef find_argument_ref(char short_name) const override;
+    ArgumentRef find_argument_ref(std::string_view long_name) const override;
+    ArgumentRef get_argument_ref(size_t idx) const override;
+    size_t find_missing_required(size_t from) const override;
+    std::error_code check_provided(const details::NodeBits& provided, Diagnostics& diagnostics) const override;
+
+    void reset_to_default() noexcept override;
+
+    // options built later are compiled right after the factory
+    void compile() override;
+
+    bool is_materialized() const noexcept;
+
+private:
+    const OptionsPtr& materialize() const;
+
+private:
+    std::string name_;
+    std::string description_;
+    mutable Factory factory_;
+    mutable OptionsPtr options_;
+    bool compiled_ = false;
+};
+
 }  // namespace xdx::cliopts
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <xdx/cliopts/argv.hpp>
+#include <xdx/cliopts/details/small_vector.hpp>
+#include <xdx/cliopts/diagnostic.hpp>
 #include <xdx/cliopts/error.hpp>
 #include <xdx/cliopts/options.hpp>
+#include <xdx/cliopts/record_reader.hpp>
+#include <xdx/cliopts/tokenizer.hpp>
 
+#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -17,19 +22,118 @@ public:
         : options_{options} {
     }
 
-    using SubcommandsPath = std::vector<std::string_view>;
-    using UnparsedArguments = std::vector<std::string_view>;
+    // typical command lines fit in place, so producing result doesn't touch the heap
+    using SubcommandsPath = details::SmallVector<std::string_view, 4>;
+    using UnparsedArguments = details::SmallVector<std::string_view, 8>;
     struct ProcessResult
     {
+        // code of the first diagnostic
         std::error_code error;
         SubcommandsPath subcommand_path;
         UnparsedArguments unparsed_arguments;
+        Diagnostics diagnostics;
+    };
+
+    // Allows git-style unique prefixes of subcommand names, e.g. `stat` for `status`.
+    Parser& allow_subcommand_abbreviations(bool allow = true) {
+        subcommand_abbreviations_ = allow;
+        return *this;
+    }
+
+    // Allows getopt_long-style unique prefixes of long names, e.g. `--verb` for `--verbose`.
+    Parser& allow_long_abbreviations(bool allow = true) {
+        long_abbreviations_ = allow;
+        return *this;
+    }
+
+    // Diagnostics are written to `errout` with single write, unless disabled by write_diagnostics(false)
+    // when caller handles them in code.
+    Parser& write_diagnostics(bool write = true) {
+        write_diagnostics_ = write;
+        return *this;
+    }
+
+    bool is_writing_diagnostics() const noexcept {
+        return write_diagnostics_;
+    }
+
+    // Parser with the same settings for other options, e.g. tool chosen by MultiCall.
+    Parser rebind(const OptionsPtr& options) const {
+        Parser parser = *this;
+        parser.options_ = options;
+        return parser;
+    }
+
+    // Receivers of parsed input for sources which can't keep it alive until the end, e.g. streams.
+    struct Callbacks
+    {
+        // called for every positional instead of collecting it into ProcessResult::unparsed_arguments
+        std::function<void(std::string_view)> positional;
+        // called after value of argument is converted, list arguments are reset_to_default() right after
+        // the call, so their values don't pile up
+        std::function<void(iArgument&)> value;
+    };
+
+    // State of single command line which is fed token by token, so input can be parsed while it arrives.
+    class Session
+    {
+    public:
+        Session(const Parser& parser, Callbacks callbacks = {}, std::vector<bool>* passed = nullptr);
+
+        // `entry` is index of the record the token was taken from. Returns false after an error,
+        // the rest of input must not be fed then.
+        bool feed(const Tokenizer::Token& token, size_t entry);
+
+        // checks required arguments and constraints of the last command
+        ProcessResult finish();
+
+    private:
+        Diagnostic* _report(DiagnosticId id, ProcessingArgumentsError error, size_t entry, std::string name);
+        void _mark_provided(size_t node);
+        bool _feed_value(const Tokenizer::Token& token, size_t entry);
+
+    private:
+        const Parser& parser_;
+        Callbacks callbacks_;
+        std::vector<bool>* passed_;
+        ProcessResult result_;
+        Options::SubcommandPtr current_command_;
+        ArgumentRef current_argument_;
+        size_t current_argument_entry_ = 0;
+        // nodes of current command given on command line
+        details::NodeBits provided_;
+        bool positional_seen_ = false;
+        // entry of the last known short switch, to find partly known groups when passing through
+        size_t known_short_entry_ = Diagnostic::NO_ARGV_INDEX;
+        char passed_short_ = '\0';
     };
 
     ProcessResult process(Argv&& argv, std::ostream& errout = std::cerr);
 
+    // Parses known options and strips them from argv in one linear pass, so the rest can be handed
+    // to another library. Unknown switches and positional arguments are kept in their original order,
+    // argc is updated and argv[argc] is set to nullptr. On error argv is left untouched.
+    // A group of short switches is passed through only if none of them is known, a partly known group
+    // like `-vx` is reported as unknown switcher. A separate value of an unknown switch can't be told
+    // from a positional: it's kept in argv too, but it also ends subcommand detection.
+    ProcessResult process_pass_through(int& argc, const char** argv, std::ostream& errout = std::cerr);
+    ProcessResult process_pass_through(int& argc, char** argv, std::ostream& errout = std::cerr) {
+        return process_pass_through(argc, const_cast<const char**>(argv), errout);
+    }
+
+    // Parses records as they are read, each record is a single argv entry. Positionals and values are
+    // delivered to callbacks, so memory use doesn't depend on input size. Entries of diagnostics are
+    // record indices. Options are compiled first. Records don't outlive the next read, so
+    // `callbacks.positional` is required, std::invalid_argument is thrown without it.
+    ProcessResult process_stream(RecordReader& reader, Callbacks callbacks, std::ostream& errout = std::cerr);
+
 private:
+    ProcessResult _process(Argv& argv, std::vector<bool>* passed);
+
     OptionsPtr options_;
+    bool subcommand_abbreviations_ = false;
+    bool long_abbreviations_ = false;
+    bool write_diagnostics_ = true;
 };
 
 inline Parser::ProcessResult parse_argv(const OptionsPtr& options, int argc, const char** argv) {
@@ -37,9 +141,19 @@ inline Parser::ProcessResult parse_argv(const OptionsPtr& options, int argc, con
     return parser.process({argc, argv});
 }
 
+inline Parser::ProcessResult parse_argv_pass_through(const OptionsPtr& options, int& argc, char** argv) {
+    Parser parser(options);
+    return parser.process_pass_through(argc, argv);
+}
+
 inline Parser::ProcessResult parse_argv(const OptionsPtr& options, Argv&& argv) {
     Parser parser(options);
     return parser.process(std::move(argv));
 }
 
+// Parses command line of the current process, see self_argv().
+inline Parser::ProcessResult parse_argv(const OptionsPtr& options) {
+    return parse_argv(options, self_argv());
+}
+
 }  // namespace xdx::cliopts
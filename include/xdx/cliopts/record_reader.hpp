@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+// Reads delimited records, e.g. output of `find -print0` or `xargs -0` style input, from a file descriptor
+// in chunks, so arbitrary long input is processed in bounded memory. Buffer grows only when a single
+// record doesn't fit into it. The descriptor is not owned.
+class RecordReader
+{
+public:
+    RecordReader(int fd, char delimiter = '\0', size_t chunk_size = 64 * 1024);
+
+    // Returns NUL terminated record valid until the next call, last record may lack the delimiter.
+    // Throws std::system_error when read fails.
+    std::pair<bool, const char*> next();
+
+    // index of the record the last next() returned
+    size_t index() const noexcept {
+        return index_ - 1;
+    }
+
+private:
+    bool _fill();
+
+    int fd_;
+    char delimiter_;
+    std::vector<char> buffer_;
+    // unconsumed bytes are buffer_[begin_, end_)
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t index_ = 0;
+    bool eof_ = false;
+};
+
+}  // namespace xdx::cliopts
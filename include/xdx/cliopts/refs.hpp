@@ -0,0 +1,129 @@
+#pragma once
+
+#include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/flag.hpp>
+
+#include <cstddef>
+#include <variant>
+
+namespace xdx::cliopts
+{
+
+inline constexpr size_t NO_NODE = static_cast<size_t>(-1);
+
+// Non-owning reference to a flag. Built-in kinds are called directly through their final overrides,
+// user implementations of iFlag stay behind the virtual interface.
+class FlagRef
+{
+public:
+    FlagRef() noexcept = default;
+
+    // Kind is found once, when node is added, so dispatch later is a jump table.
+    static FlagRef classify(iFlag* flag) noexcept {
+        return flag ? FlagRef{flag->typed_ref()} : FlagRef{};
+    }
+
+    static FlagRef generic(iFlag* flag) noexcept {
+        return FlagRef{details::FlagVariant{std::in_place_index<0>, flag}};
+    }
+
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+
+    iFlag* get() const noexcept {
+        return std::visit([](auto* flag) -> iFlag* { return flag; }, ref_);
+    }
+
+    bool is_generic() const noexcept {
+        return ref_.index() == 0;
+    }
+
+    void set_found() const noexcept {
+        std::visit([](auto* flag) { flag->set_found(); }, ref_);
+    }
+
+    // entry in node table of options the flag belongs to, NO_NODE for refs made outside of Options
+    size_t node() const noexcept {
+        return node_;
+    }
+
+    FlagRef at_node(size_t node) const noexcept {
+        FlagRef result = *this;
+        result.node_ = node;
+        return result;
+    }
+
+private:
+    explicit FlagRef(details::FlagVariant ref) noexcept
+        : ref_{ref} {
+    }
+
+private:
+    details::FlagVariant ref_{std::in_place_index<0>, nullptr};
+    size_t node_ = NO_NODE;
+};
+
+// Non-owning reference to an argument, closed over built-in value types the same way as FlagRef.
+class ArgumentRef
+{
+public:
+    ArgumentRef() noexcept = default;
+
+    static ArgumentRef classify(iArgument* argument) noexcept {
+        return argument ? ArgumentRef{argument->typed_ref()} : ArgumentRef{};
+    }
+
+    static ArgumentRef generic(iArgument* argument) noexcept {
+        return ArgumentRef{details::ArgumentVariant{std::in_place_index<0>, argument}};
+    }
+
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+
+    iArgument* get() const noexcept {
+        return std::visit([](auto* argument) -> iArgument* { return argument; }, ref_);
+    }
+
+    iArgument* operator->() const noexcept {
+        return get();
+    }
+
+    bool is_generic() const noexcept {
+        return ref_.index() == 0;
+    }
+
+    bool is_required() const noexcept {
+        return std::visit([](auto* argument) { return argument->is_required(); }, ref_);
+    }
+
+    bool has_value() const noexcept {
+        return std::visit([](auto* argument) { return argument->has_value(); }, ref_);
+    }
+
+    std::pair<bool, std::string> set_string_value(std::string_view value) const noexcept {
+        return std::visit([value](auto* argument) { return argument->set_string_value(value); }, ref_);
+    }
+
+    size_t node() const noexcept {
+        return node_;
+    }
+
+    ArgumentRef at_node(size_t node) const noexcept {
+        ArgumentRef result = *this;
+        result.node_ = node;
+        return result;
+    }
+
+private:
+    explicit ArgumentRef(details::ArgumentVariant ref) noexcept
+        : ref_{ref} {
+    }
+
+private:
+    details::ArgumentVariant ref_{std::in_place_index<0>, nullptr};
+    size_t node_ = NO_NODE;
+};
+
+}  // namespace xdx::cliopts
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/flag.hpp>
+#include <xdx/cliopts/options.hpp>
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+// Serializes whole options tree (names, descriptions, types, defaults, allowed values, delimiters and
+// structure) into flat position independent blob with sorted name indexes of every node. Offsets are
+// relative to the blob start, integers are in host byte order.
+std::string serialize_schema(const iOptions& options);
+
+// Loaded tree is queried in place: names are binary searched in the blob, and nodes, flags and arguments
+// are created on their first lookup.
+
+// Maps schema file read-only and returns options tree which is backed by the mapping.
+OptionsPtr load_schema(const std::string& path);
+
+// Returns options tree backed by caller owned blob. Blob must be 4-byte aligned and outlive the tree.
+OptionsPtr load_schema(std::string_view blob);
+
+enum class SchemaValueKind : uint8_t
+{
+    Other = 0,
+    Short,
+    UShort,
+    Int,
+    UInt,
+    Long,
+    ULong,
+    LongLong,
+    ULongLong,
+    Float,
+    Double,
+    LongDouble,
+    String,
+};
+
+// Flags and arguments of loaded schema are not Flag/FlagCount/Argument<T> instances, so
+// find_flag_count() and find_typed_argument<T>() don't apply to them. Cast results of
+// find_flag()/find_argument() to these classes to read counts and typed values.
+class SchemaFlag : public iFlag
+{
+public:
+    SchemaFlag(char short_name, bool countable, std::string_view long_name, std::string_view description) noexcept;
+
+    char get_short_name() const noexcept final;
+    std::string_view get_long_name() const noexcept final;
+    std::string_view get_description() const noexcept final;
+    bool is_countable() const noexcept final;
+    void set_found() noexcept final;
+    void set_count(size_t count) noexcept final;
+    bool is_set() const noexcept final;
+    void reset_to_default() noexcept final;
+    size_t get_count() const noexcept final;
+
+private:
+    char short_name_;
+    bool countable_;
+    size_t count_ = 0;
+    std::string_view long_name_;
+    std::string_view description_;
+};
+
+class SchemaArgument : public iArgument
+{
+public:
+    struct Attributes
+    {
+        char short_name = '\0';
+        SchemaValueKind kind = SchemaValueKind::Other;
+        bool required = false;
+        bool many_values = false;
+        bool has_default = false;
+        std::string_view long_name;
+        std::string_view description;
+        std::string_view type_name;
+        std::string_view default_value;
+        // splits every occurrence into many values, see ArgumentList::set_delimiter()
+        char delimiter = '\0';
+        char escape = '\0';
+        // restricts values to these strings, e.g. names of Choice
+        std::vector<std::string_view> allowed_values;
+    };
+
+    SchemaArgument(Attributes attributes) noexcept;
+
+    char get_short_name() const noexcept final;
+    std::string_view get_long_name() const noexcept final;
+    std::string_view get_description() const noexcept final;
+    std::string_view get_type_name() const final;
+    std::string_view get_default_value() const final;
+    bool has_value() const noexcept final;
+    bool has_default_value() const noexcept final;
+    bool is_required() const noexcept final;
+    bool is_many_values() const noexcept final;
+    void reset_to_default() noexcept final;
+    std::pair<bool, std::string> set_string_value(const std::string_view& value) noexcept final;
+    bool save_state(details::StateWriter& out) const final;
+    void restore_state(details::StateReader& in) final;
+    size_t allowed_values_count() const noexcept final;
+    std::string_view get_allowed_value(size_t idx) const noexcept final;
+
+    SchemaValueKind get_value_kind() const noexcept;
+    char get_delimiter() const noexcept;
+    char get_escape() const noexcept;
+
+    // Values are validated against the serialized type when they are set and are converted on the first
+    // read, the result is kept until values change, so repeated reads don't parse text again.
+    template <class ValueType>
+    ValueType get_value() const {
+        if (const auto* cached = std::any_cast<ValueType>(&value_cache_)) {
+            return *cached;
+        }
+
+        std::optional<ValueType> value;
+        parse_value(values_.empty() ? attributes_.default_value : std::string_view{values_.back()}, &value);
+        value_cache_ = value ? std::move(*value) : ValueType{};
+        return std::any_cast<const ValueType&>(value_cache_);
+    }
+
+    template <class ValueType>
+    std::vector<ValueType> get_values() const {
+        if (const auto* cached = std::any_cast<std::vector<ValueType>>(&values_cache_)) {
+            return *cached;
+        }
+
+        std::vector<ValueType> result;
+        if (values_.empty()) {
+            result.push_back(get_value<ValueType>());
+        } else {
+            result.reserve(values_.size());
+            for (const auto& text : values_) {
+                std::optional<ValueType> value;
+                parse_value(text, &value);
+                result.emplace_back(value ? *value : ValueType{});
+            }
+        }
+        values_cache_ = result;
+        return result;
+    }
+
+private:
+    std::pair<bool, std::string> _validate(std::string_view value) const;
+    void _drop_cache() noexcept;
+
+private:
+    Attributes attributes_;
+    std::vector<std::string> values_;
+    // converted values of the type they were last read as
+    mutable std::any value_cache_;
+    mutable std::any values_cache_;
+};
+
+}  // namespace xdx::cliopts
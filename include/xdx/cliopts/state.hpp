@@ -0,0 +1,23 @@
+#pragma once
+
+#include <xdx/cliopts/options.hpp>
+#include <xdx/cliopts/parser.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace xdx::cliopts
+{
+
+// Serializes parsed state of options tree: set flags with their counts, values given on command line and
+// subcommand path, so workers of the same binary can take it over without parsing, e.g. through inherited fd
+// or shared memory. Values are written in their binary form, flags and arguments are referred by index, so
+// both sides must use the same schema. Integers are in host byte order.
+std::string serialize_state(const iOptions& options, const Parser::SubcommandsPath& path);
+
+// Resets `options` and restores state written by serialize_state() without tokenizing or converting values.
+// Returned path refers to names of subcommands. Throws std::invalid_argument if blob is malformed or
+// doesn't match the options, `options` are reset to default then.
+Parser::SubcommandsPath restore_state(std::string_view blob, iOptions& options);
+
+}  // namespace xdx::cliopts
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/parser.hpp>
+#include <xdx/cliopts/printer.hpp>
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace xdx::cliopts
+{
+
+enum class FieldKind
+{
+    Flag,
+    FlagCount,
+    Argument,
+    ArgumentList,
+};
+
+namespace details
+{
+
+template <class Type>
+struct IsVector : std::false_type
+{};
+
+template <class Type, class Allocator>
+struct IsVector<std::vector<Type, Allocator>> : std::true_type
+{};
+
+template <class Member>
+constexpr FieldKind field_kind() {
+    if constexpr (std::is_same_v<Member, bool>) {
+        return FieldKind::Flag;
+    } else if constexpr (IsVector<Member>::value) {
+        return FieldKind::ArgumentList;
+    } else {
+        return FieldKind::Argument;
+    }
+}
+
+}  // namespace details
+
+// Single entry of compile time field table. Use '\0' or "" for the absent name.
+template <class Struct, class Member, FieldKind Kind>
+struct Field
+{
+    using struct_type = Struct;
+    using member_type = Member;
+    static constexpr FieldKind KIND = Kind;
+
+    Member Struct::*member;
+    char short_name;
+    std::string_view long_name;
+    std::string_view description;
+    bool required;
+};
+
+// bool members become flags, std::vector members become argument lists, the rest are arguments
+template <class Struct, class Member>
+constexpr auto field(Member Struct::*member, char short_name, std::string_view long_name, std::string_view description,
+                     bool required = false) {
+    return Field<Struct, Member, details::field_kind<Member>()>{member, short_name, long_name, description, required};
+}
+
+template <class Struct>
+constexpr auto count_field(size_t Struct::*member, char short_name, std::string_view long_name,
+                           std::string_view description) {
+    return Field<Struct, size_t, FieldKind::FlagCount>{member, short_name, long_name, description, false};
+}
+
+// Plain struct described by compile time field table. Parsing goes through Parser over options tree
+// bound to the struct members, so converted values are written straight into the struct and nothing
+// has to be looked up or cast afterwards.
+template <class Struct, class... Fields>
+class StructBinding
+{
+public:
+    constexpr StructBinding(std::string_view name, std::string_view description, Fields... fields)
+        : name_{name}
+        , description_{description}
+        , fields_{fields...} {
+    }
+
+    // Parses argv into `target` by `parser` rebound to describe(target), so its settings apply, e.g.
+    // abbreviations or write_diagnostics(false). Fields which aren't given keep values `target` had.
+    Parser::ProcessResult process(Argv&& argv, Struct& target, const Parser& parser,
+                                  std::ostream& errout = std::cerr) const {
+        return parser.rebind(describe(target)).process(std::move(argv), errout);
+    }
+
+    // same with default Parser settings
+    Parser::ProcessResult process(Argv&& argv, Struct& target, std::ostream& errout = std::cerr) const {
+        return process(std::move(argv), target, Parser(nullptr), errout);
+    }
+
+    // Builds options tree bound to `target` through Builder, e.g. for Printer or Completer.
+    // Current values of `target` are shown as defaults.
+    std::shared_ptr<Options> describe(Struct& target) const {
+        Builder builder(name_, description_);
+        for_each([&](size_t, const auto& field) { add(builder, target, field); });
+        return builder.get_options();
+    }
+
+    void print_short(std::ostream& out, Struct& defaults) const {
+        Printer(describe(defaults)).print_short(out);
+    }
+
+    void print_long(std::ostream& out, Struct& defaults) const {
+        Printer(describe(defaults)).print_long(out);
+    }
+
+private:
+    template <class Callable>
+    void for_each(Callable&& callable) const {
+        for_each(callable, std::index_sequence_for<Fields...>{});
+    }
+
+    template <class Callable, size_t... Idx>
+    void for_each(Callable& callable, std::index_sequence<Idx...>) const {
+        (callable(Idx, std::get<Idx>(fields_)), ...);
+    }
+
+    template <class FieldType>
+    static void add(Builder& builder, Struct& target, const FieldType& field) {
+        auto* storage = &(target.*field.member);
+        if constexpr (FieldType::KIND == FieldKind::Flag) {
+            add_named(field, [&](auto... names) { builder.flag(storage, names..., field.description); });
+        } else if constexpr (FieldType::KIND == FieldKind::FlagCount) {
+            add_named(field, [&](auto... names) { builder.flag_count(storage, names..., field.description); });
+        } else if constexpr (FieldType::KIND == FieldKind::ArgumentList) {
+            add_named(field, [&](auto... names) {
+                builder.argument_list(storage, names..., field.description, field.required);
+            });
+        } else {
+            add_named(field,
+                      [&](auto... names) { builder.argument(storage, names..., field.description, field.required); });
+        }
+    }
+
+    template <class FieldType, class Callable>
+    static void add_named(const FieldType& field, Callable&& callable) {
+        if (field.short_name == '\0') {
+            callable(field.long_name);
+        } else if (field.long_name.empty()) {
+            callable(field.short_name);
+        } else {
+            callable(field.short_name, field.long_name);
+        }
+    }
+
+private:
+    std::string_view name_;
+    std::string_view description_;
+    std::tuple<Fields...> fields_;
+};
+
+template <class First, class... Rest>
+StructBinding(std::string_view, std::string_view, First, Rest...)
+    -> StructBinding<typename First::struct_type, First, Rest...>;
+
+}  // namespace xdx::cliopts
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <xdx/cliopts/argv.hpp>
 
 #include <variant>
@@ -36,6 +38,11 @@ public:
 
     std::pair<bool, Token> next();
 
+    // index of the argv entry the last returned token was taken from
+    size_t entry() const noexcept {
+        return static_cast<size_t>(entry_idx_);
+    }
+
 private:
     Argv& argv_;
     TokenType current_token_;
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <xdx/cliopts/details/from_string.hpp>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace xdx::cliopts
+{
+
+// Customization point for argument value types. Specialize it for own type to parse values
+// without streams:
+//
+//   template <>
+//   struct xdx::cliopts::ValueParser<Duration>
+//   {
+//       static std::pair<bool, std::string> parse(std::string_view text, std::optional<Duration>* value);
+//   };
+//
+// On success `value` is set and the second member is empty, otherwise it holds error message.
+// Types without specialization are read through operator>>.
+template <class ValueType, class Enable = void>
+struct ValueParser
+{
+    static std::pair<bool, std::string> parse(std::string_view text, std::optional<ValueType>* value) {
+        return details::from_string(value, std::string{text});
+    }
+};
+
+namespace details
+{
+
+// narrow char types are read as characters by the fallback, wide ones have no operator>> for narrow
+// streams, so none of them are treated as numbers here
+template <class Type>
+inline constexpr bool is_char_v = std::is_same_v<Type, char> || std::is_same_v<Type, signed char> ||
+                                  std::is_same_v<Type, unsigned char> || std::is_same_v<Type, wchar_t> ||
+#if defined(__cpp_char8_t)
+                                  std::is_same_v<Type, char8_t> ||
+#endif
+                                  std::is_same_v<Type, char16_t> || std::is_same_v<Type, char32_t>;
+
+template <class Type>
+inline constexpr bool is_plain_integer_v = std::is_integral_v<Type> && !std::is_same_v<Type, bool> && !is_char_v<Type>;
+
+}  // namespace details
+
+template <class ValueType>
+struct ValueParser<ValueType, std::enable_if_t<details::is_plain_integer_v<ValueType>>>
+{
+    static std::pair<bool, std::string> parse(std::string_view text, std::optional<ValueType>* value) {
+        return details::from_chars(value, text);
+    }
+};
+
+template <class ValueType>
+struct ValueParser<ValueType, std::enable_if_t<std::is_floating_point_v<ValueType>>>
+{
+    static std::pair<bool, std::string> parse(std::string_view text, std::optional<ValueType>* value) {
+        return details::from_chars(value, text);
+    }
+};
+
+template <>
+struct ValueParser<std::string>
+{
+    static std::pair<bool, std::string> parse(std::string_view text, std::optional<std::string>* value) {
+        *value = std::string{text};
+        return {true, std::string{}};
+    }
+};
+
+template <class ValueType>
+inline std::pair<bool, std::string> parse_value(std::string_view text, std::optional<ValueType>* value) {
+    return ValueParser<ValueType>::parse(text, value);
+}
+
+}  // namespace xdx::cliopts
@@ -0,0 +1,81 @@
+#include <xdx/cliopts/argv.hpp>
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+struct Cmdline
+{
+    Cmdline() {
+        const int fd = ::open("/proc/self/cmdline", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "can't open '/proc/self/cmdline'");
+        }
+
+        // procfs reports zero size, so it is read until the end
+        size_t size = 0;
+        buffer.resize(4096);
+        for (;;) {
+            if (size == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+            const auto read = ::read(fd, buffer.data() + size, buffer.size() - size);
+            if (read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (read < 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "can't read '/proc/self/cmdline'");
+            }
+            if (read == 0) {
+                break;
+            }
+            size += static_cast<size_t>(read);
+        }
+        ::close(fd);
+
+        buffer.resize(size);
+        entries = details::split_cmdline(buffer);
+    }
+
+    std::string buffer;
+    std::vector<std::string_view> entries;
+};
+
+}  // namespace
+
+namespace details
+{
+
+std::vector<std::string_view> split_cmdline(std::string_view buffer) {
+    std::vector<std::string_view> entries;
+    size_t begin = 0;
+    while (begin < buffer.size()) {
+        auto end = buffer.find('\0', begin);
+        if (end == buffer.npos) {
+            end = buffer.size();
+        }
+        entries.push_back(buffer.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return entries;
+}
+
+}  // namespace details
+
+Argv self_argv() {
+    static const Cmdline cmdline;
+    return Argv(cmdline.entries);
+}
+
+}  // namespace xdx::cliopts
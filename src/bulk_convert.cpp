@@ -0,0 +1,256 @@
+#include <xdx/cliopts/bulk_convert.hpp>
+#include <xdx/cliopts/details/from_string.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+constexpr uint64_t SWAR_ZEROS = 0x3030303030303030ull;
+constexpr uint64_t SWAR_LOW_NIBBLES = 0x0f0f0f0f0f0f0f0full;
+constexpr uint64_t SWAR_HIGH_NIBBLES = 0xf0f0f0f0f0f0f0f0ull;
+constexpr uint64_t SWAR_SIXES = 0x0606060606060606ull;
+
+// 19 decimal digits always fit into uint64_t
+constexpr size_t MAX_FAST_DIGITS = 19;
+
+uint64_t load8(const char* data) noexcept {
+    uint64_t chunk;
+    std::memcpy(&chunk, data, sizeof(chunk));
+    return chunk;
+}
+
+bool is_little_endian() noexcept {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// parse8() expects digits in little endian order, other hosts take the scalar loop
+const bool SWAR_ENABLED = is_little_endian();
+
+// all 8 bytes are in '0'..'9'
+bool all_digits8(uint64_t chunk) noexcept {
+    return (chunk & SWAR_HIGH_NIBBLES) == SWAR_ZEROS && ((chunk + SWAR_SIXES) & SWAR_HIGH_NIBBLES) == SWAR_ZEROS;
+}
+
+// value of 8 digits loaded in little endian order
+uint32_t parse8(uint64_t chunk) noexcept {
+    chunk &= SWAR_LOW_NIBBLES;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00ff00ff00ff00ffull;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000ffff0000ffffull;
+    return static_cast<uint32_t>((chunk * 10000 + (chunk >> 32)) & 0xffffffffull);
+}
+
+// Accumulates digits starting at `pos` into `value`, stops at the first non-digit. Value wraps
+// around if there are more than MAX_FAST_DIGITS of them, callers check the count.
+const char* consume_digits(const char* pos, const char* end, uint64_t* value) noexcept {
+    uint64_t result = *value;
+    if (SWAR_ENABLED) {
+        for (; end - pos >= 8; pos += 8) {
+            const uint64_t chunk = load8(pos);
+            if (!all_digits8(chunk)) {
+                break;
+            }
+            result = result * 100000000ull + parse8(chunk);
+        }
+    }
+
+    for (; pos != end; ++pos) {
+        const auto digit = static_cast<unsigned>(*pos - '0');
+        if (digit > 9) {
+            break;
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = result;
+    return pos;
+}
+
+// Parses at most MAX_FAST_DIGITS digits, false if there is anything else.
+bool parse_digits(std::string_view digits, uint64_t* result) noexcept {
+    if (digits.empty() || digits.size() > MAX_FAST_DIGITS) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    const char* end = digits.data() + digits.size();
+    if (consume_digits(digits.data(), end, &value) != end) {
+        return false;
+    }
+
+    *result = value;
+    return true;
+}
+
+template <class Integer>
+bool fast_integer(std::string_view text, Integer* value) noexcept {
+    bool negative = false;
+    if (!text.empty() && (text.front() == '+' || text.front() == '-')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    uint64_t magnitude = 0;
+    if (!parse_digits(text, &magnitude)) {
+        return false;
+    }
+
+    if constexpr (std::is_signed_v<Integer>) {
+        using Unsigned = std::make_unsigned_t<Integer>;
+        const auto limit = static_cast<uint64_t>(static_cast<Unsigned>(std::numeric_limits<Integer>::max())) +
+                           (negative ? 1 : 0);
+        if (magnitude > limit) {
+            return false;
+        }
+        *value = negative ? static_cast<Integer>(0 - static_cast<Unsigned>(magnitude))
+                          : static_cast<Integer>(magnitude);
+    } else {
+        if (negative || magnitude > std::numeric_limits<Integer>::max()) {
+            return false;
+        }
+        *value = static_cast<Integer>(magnitude);
+    }
+    return true;
+}
+
+// Clinger's fast path: mantissa below 2^53 and power of ten up to 22 are exact doubles,
+// so single multiplication or division rounds correctly.
+bool fast_double(std::string_view text, double* value) noexcept {
+    static constexpr double POWERS[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    constexpr int MAX_POWER = 22;
+    constexpr uint64_t MAX_MANTISSA = uint64_t{1} << 53;
+
+    const char* pos = text.data();
+    const char* end = pos + text.size();
+
+    bool negative = false;
+    if (pos != end && (*pos == '+' || *pos == '-')) {
+        negative = *pos == '-';
+        ++pos;
+    }
+
+    uint64_t mantissa = 0;
+    const char* integral = pos;
+    pos = consume_digits(pos, end, &mantissa);
+    size_t digits = static_cast<size_t>(pos - integral);
+
+    int exponent = 0;
+    if (pos != end && *pos == '.') {
+        const char* fraction = ++pos;
+        pos = consume_digits(pos, end, &mantissa);
+        digits += static_cast<size_t>(pos - fraction);
+        exponent = -static_cast<int>(pos - fraction);
+    }
+
+    if (digits == 0 || digits > MAX_FAST_DIGITS) {
+        return false;
+    }
+
+    if (pos != end && (*pos == 'e' || *pos == 'E')) {
+        ++pos;
+        bool negative_exponent = false;
+        if (pos != end && (*pos == '+' || *pos == '-')) {
+            negative_exponent = *pos == '-';
+            ++pos;
+        }
+
+        uint64_t magnitude = 0;
+        const char* exponent_digits = pos;
+        pos = consume_digits(pos, end, &magnitude);
+        if (pos == exponent_digits || pos - exponent_digits > 3) {
+            return false;
+        }
+        exponent += negative_exponent ? -static_cast<int>(magnitude) : static_cast<int>(magnitude);
+    }
+
+    if (pos != end) {
+        return false;
+    }
+
+    if (mantissa > MAX_MANTISSA || exponent < -MAX_POWER || exponent > MAX_POWER) {
+        return false;
+    }
+
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / POWERS[-exponent] : result * POWERS[exponent];
+    *value = negative ? -result : result;
+    return true;
+}
+
+template <class ValueType, class FastPath>
+size_t convert(const std::string_view* texts, size_t count, ValueType* values,
+               std::vector<BulkConversionError>* errors, FastPath fast_path) {
+    size_t converted = 0;
+    for (size_t idx = 0; idx < count; ++idx) {
+        if (fast_path(texts[idx], &values[idx])) {
+            converted += 1;
+            continue;
+        }
+
+        std::optional<ValueType> value;
+        auto [success, message] = details::from_chars(&value, texts[idx]);
+        if (success) {
+            values[idx] = *value;
+            converted += 1;
+        } else if (errors) {
+            errors->push_back({idx, std::move(message)});
+        }
+    }
+    return converted;
+}
+
+template <class Integer>
+size_t convert_integers(const std::string_view* texts, size_t count, Integer* values,
+                        std::vector<BulkConversionError>* errors) {
+    return convert(texts, count, values, errors, fast_integer<Integer>);
+}
+
+}  // namespace
+
+size_t convert_bulk(const std::string_view* texts, size_t count, int* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned int* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, long* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned long* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, long long* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, unsigned long long* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert_integers(texts, count, values, errors);
+}
+
+size_t convert_bulk(const std::string_view* texts, size_t count, double* values,
+                    std::vector<BulkConversionError>* errors) {
+    return convert(texts, count, values, errors, fast_double);
+}
+
+}  // namespace xdx::cliopts
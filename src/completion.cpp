@@ -0,0 +1,155 @@
+#include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/completion.hpp>
+#include <xdx/cliopts/flag.hpp>
+#include <xdx/cliopts/tokenizer.hpp>
+
+#include <string>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+bool starts_with(std::string_view str, std::string_view prefix) {
+    return str.substr(0, prefix.size()) == prefix;
+}
+
+// `partial` always starts with '-' here
+template <class Source>
+void complete_names(std::ostream& out, const Source& source, std::string_view partial) {
+    const auto short_name = source->get_short_name();
+    if (short_name != '\0' && (partial.size() == 1 || (partial.size() == 2 && partial[1] == short_name))) {
+        out << '-' << short_name << '\n';
+    }
+
+    const auto long_name = source->get_long_name();
+    if (long_name.empty()) {
+        return;
+    }
+
+    if (partial.size() == 1 || (partial[1] == '-' && starts_with(long_name, partial.substr(2)))) {
+        out << "--" << long_name << '\n';
+    }
+}
+
+std::string function_name(std::string_view program) {
+    std::string name = "_";
+    for (char ch : program) {
+        const bool valid = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9');
+        name += valid ? ch : '_';
+    }
+    name += "_xdx_complete";
+    return name;
+}
+
+}  // namespace
+
+void Completer::complete(Argv&& words, std::string_view partial, std::ostream& out) {
+    Options::SubcommandPtr current_command = options_;
+    Tokenizer tokenizer(words);
+
+    bool expecting_value = false;
+    bool positional = false;
+    bool not_end = false;
+    Tokenizer::Token token;
+
+    for (std::tie(not_end, token) = tokenizer.next(); not_end; std::tie(not_end, token) = tokenizer.next()) {
+        if (expecting_value) {
+            expecting_value = false;
+            if (token.type == Tokenizer::TokenType::None) {
+                continue;
+            }
+        }
+
+        switch (token.type) {
+            case Tokenizer::TokenType::Short:
+                if (!current_command->find_flag(token.get_short())) {
+                    expecting_value = current_command->find_argument(token.get_short()) != nullptr;
+                }
+                break;
+            case Tokenizer::TokenType::Long:
+                if (!current_command->find_flag(token.get_long())) {
+                    expecting_value = current_command->find_argument(token.get_long()) != nullptr;
+                }
+                break;
+            case Tokenizer::TokenType::None:
+                if (!positional) {
+                    auto command = current_command->find_subcommand(token.get_long());
+                    if (command) {
+                        current_command = command;
+                    } else {
+                        positional = true;
+                    }
+                }
+                break;
+            case Tokenizer::TokenType::Unknown:
+                break;
+        }
+    }
+
+    if (expecting_value) {
+        return;
+    }
+
+    if (starts_with(partial, "-")) {
+        for (size_t i = 0; i < current_command->flags_count(); ++i) {
+            complete_names(out, current_command->get_flag(i), partial);
+        }
+
+        for (size_t i = 0; i < current_command->arguments_count(); ++i) {
+            complete_names(out, current_command->get_argument(i), partial);
+        }
+        return;
+    }
+
+    if (positional) {
+        return;
+    }
+
+    for (size_t i = 0; i < current_command->subcommands_count(); ++i) {
+        const auto subcommand = current_command->get_subcommand(i);
+        if (starts_with(subcommand->get_name(), partial)) {
+            out << subcommand->get_name() << '\n';
+        }
+    }
+}
+
+void Completer::print_script(std::ostream& out, Shell shell, std::string_view program) {
+    const auto function = function_name(program);
+
+    switch (shell) {
+        case Shell::Bash:
+            out << function << "() {\n"
+                << "    local IFS=$'\\n'\n"
+                << "    COMPREPLY=($(\"${COMP_WORDS[0]}\" " << COMMAND
+                << " \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>/dev/null))\n"
+                << "}\n"
+                << "complete -o default -F " << function << ' ' << program << '\n';
+            break;
+        case Shell::Zsh:
+            out << "#compdef " << program << '\n'
+                << function << "() {\n"
+                << "    local -a candidates\n"
+                << "    candidates=(${(f)\"$(\"${words[1]}\" " << COMMAND
+                << " \"${(@)words[2,CURRENT]}\" 2>/dev/null)\"})\n"
+                << "    if (( ${#candidates} )); then\n"
+                << "        compadd -a candidates\n"
+                << "    else\n"
+                << "        _files\n"
+                << "    fi\n"
+                << "}\n"
+                << "compdef " << function << ' ' << program << '\n';
+            break;
+        case Shell::Fish:
+            out << "function " << function << '\n'
+                << "    set -l tokens (commandline -opc)\n"
+                << "    set -l current (commandline -ct)\n"
+                << "    $tokens[1] " << COMMAND << " $tokens[2..-1] \"$current\" 2>/dev/null\n"
+                << "end\n"
+                << "complete -c " << program << " -a '(" << function << ")'\n";
+            break;
+    }
+}
+
+}  // namespace xdx::cliopts
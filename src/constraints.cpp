@@ -0,0 +1,33 @@
+#include <xdx/cliopts/details/constraints.hpp>
+
+namespace xdx::cliopts::details
+{
+
+size_t Constraints::find_violated(const NodeBits& provided, size_t from) const noexcept {
+    for (size_t idx = from; idx < constraints_.size(); ++idx) {
+        const auto& constraint = constraints_[idx];
+        bool violated = false;
+        switch (constraint.kind) {
+            case ConstraintKind::MutuallyExclusive:
+                violated = constraint.nodes.count_common(provided) > 1;
+                break;
+            case ConstraintKind::Requires:
+                violated = constraint.trigger.intersects(provided) &&
+                           constraint.nodes.find_not_in(provided) != NodeBits::NPOS;
+                break;
+            case ConstraintKind::AtLeastOne:
+                violated = !constraint.nodes.intersects(provided);
+                break;
+        }
+        if (violated) {
+            return idx;
+        }
+    }
+    return NPOS;
+}
+
+void Constraints::shrink_to_fit() {
+    constraints_.shrink_to_fit();
+}
+
+}  // namespace xdx::cliopts::details
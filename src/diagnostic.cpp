@@ -0,0 +1,88 @@
+#include <xdx/cliopts/diagnostic.hpp>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+void append_quoted(std::string& out, const std::vector<std::string>& names) {
+    for (size_t idx = 0; idx < names.size(); ++idx) {
+        out += idx != 0 ? ", '" : "'";
+        out += names[idx];
+        out += '\'';
+    }
+}
+
+void append_spaced(std::string& out, const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        out += ' ';
+        out += name;
+    }
+}
+
+}  // namespace
+
+void render(std::string& out, const Diagnostic& diagnostic) {
+    switch (diagnostic.id) {
+        case DiagnosticId::ExpectedValue:
+            out += "Argument '" + diagnostic.name + "' expected value";
+            break;
+        case DiagnosticId::UnknownSwitcher:
+            out += "Unknown switcher: '" + diagnostic.name + "'";
+            break;
+        case DiagnosticId::AmbiguousSwitcher:
+            out += "Ambiguous switcher '" + diagnostic.name + "', candidates:";
+            append_spaced(out, diagnostic.related);
+            break;
+        case DiagnosticId::WrongValue:
+            out += diagnostic.message;
+            break;
+        case DiagnosticId::AmbiguousSubcommand:
+            out += "Ambiguous subcommand '" + diagnostic.name + "', candidates:";
+            append_spaced(out, diagnostic.related);
+            break;
+        case DiagnosticId::RequiredArgument:
+            out += "Argument '" + diagnostic.name + "' required value";
+            break;
+        case DiagnosticId::MutuallyExclusive:
+            out += "Switchers ";
+            append_quoted(out, diagnostic.related);
+            out += " can't be used together";
+            break;
+        case DiagnosticId::MissingDependency:
+            out += "Switcher '" + diagnostic.name + "' requires ";
+            append_quoted(out, diagnostic.related);
+            break;
+        case DiagnosticId::AtLeastOneRequired:
+            out += "One of ";
+            append_quoted(out, diagnostic.related);
+            out += " is required";
+            break;
+        case DiagnosticId::UnknownTool:
+            out += diagnostic.name.empty() ? "Expected tool name" : "Unknown tool '" + diagnostic.name + "'";
+            out += ", available:";
+            append_spaced(out, diagnostic.related);
+            break;
+    }
+    out += '\n';
+}
+
+std::string render(const Diagnostics& diagnostics) {
+    std::string out;
+    for (const auto& diagnostic : diagnostics) {
+        render(out, diagnostic);
+    }
+    return out;
+}
+
+void write_diagnostics(std::ostream& out, const Diagnostics& diagnostics) {
+    if (diagnostics.empty()) {
+        return;
+    }
+    const auto text = render(diagnostics);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    out.flush();
+}
+
+}  // namespace xdx::cliopts
@@ -24,6 +24,16 @@ std::string ProcessingArgumentsErrorCategory::message(int val) const {
             return "Calling unknown subcomand";
         case ProcessingArgumentsError::RequiredArgument:
             return "Required argument";
+        case ProcessingArgumentsError::AmbiguousSubcommand:
+            return "Ambiguous subcommand abbreviation";
+        case ProcessingArgumentsError::AmbiguousSwitcher:
+            return "Ambiguous switcher abbreviation";
+        case ProcessingArgumentsError::MutuallyExclusive:
+            return "Mutually exclusive switchers";
+        case ProcessingArgumentsError::MissingDependency:
+            return "Switcher requires another one";
+        case ProcessingArgumentsError::AtLeastOneRequired:
+            return "One of switchers is required";
     }
     return "Unkown error";
 }
@@ -6,17 +6,20 @@ namespace xdx::cliopts
 FlagBase::FlagBase(const std::string_view& long_name, const std::string_view& description)
     : long_name_{long_name}
     , description_{description} {
+    strings_.own({&long_name_, &description_});
 }
 
 FlagBase::FlagBase(char short_name, const std::string_view& description)
     : short_name_{short_name}
     , description_{description} {
+    strings_.own({&long_name_, &description_});
 }
 
 FlagBase::FlagBase(char short_name, const std::string_view& long_name, const std::string_view& description)
     : short_name_{short_name}
     , long_name_{long_name}
     , description_{description} {
+    strings_.own({&long_name_, &description_});
 }
 
 char FlagBase::get_short_name() const noexcept {
@@ -31,6 +34,10 @@ std::string_view FlagBase::get_description() const noexcept {
     return description_;
 }
 
+void FlagBase::attach_strings(const details::StringPoolPtr& pool) {
+    strings_.attach(pool, {&long_name_, &description_});
+}
+
 Flag::Flag(const std::string_view& long_name, const std::string_view& description)
     : FlagBase{long_name, description} {
 }
@@ -47,10 +54,18 @@ void Flag::set_found() noexcept {
     was_ = true;
 }
 
+void Flag::set_count(size_t count) noexcept {
+    was_ = count != 0;
+}
+
 bool Flag::is_set() const noexcept {
     return was_;
 }
 
+details::FlagVariant Flag::typed_ref() noexcept {
+    return details::make_node_variant<details::FlagVariant>(this);
+}
+
 void Flag::reset_to_default() noexcept {
     was_ = false;
 }
@@ -71,10 +86,18 @@ void FlagCount::set_found() noexcept {
     was_ += 1;
 }
 
+void FlagCount::set_count(size_t count) noexcept {
+    was_ = count;
+}
+
 bool FlagCount::is_set() const noexcept {
     return was_ != 0;
 }
 
+details::FlagVariant FlagCount::typed_ref() noexcept {
+    return details::make_node_variant<details::FlagVariant>(this);
+}
+
 size_t FlagCount::get_count() const noexcept {
     return was_;
 }
@@ -83,4 +106,92 @@ void FlagCount::reset_to_default() noexcept {
     was_ = 0;
 }
 
+BoundFlag::BoundFlag(bool* target, const std::string_view& long_name, const std::string_view& description)
+    : FlagBase{long_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+BoundFlag::BoundFlag(bool* target, char short_name, const std::string_view& description)
+    : FlagBase{short_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+BoundFlag::BoundFlag(bool* target, char short_name, const std::string_view& long_name,
+                     const std::string_view& description)
+    : FlagBase{short_name, long_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+void BoundFlag::set_found() noexcept {
+    was_ = true;
+    *target_ = true;
+}
+
+void BoundFlag::set_count(size_t count) noexcept {
+    was_ = count != 0;
+    *target_ = was_ || default_;
+}
+
+bool BoundFlag::is_set() const noexcept {
+    return was_;
+}
+
+details::FlagVariant BoundFlag::typed_ref() noexcept {
+    return details::make_node_variant<details::FlagVariant>(this);
+}
+
+void BoundFlag::reset_to_default() noexcept {
+    was_ = false;
+    *target_ = default_;
+}
+
+BoundFlagCount::BoundFlagCount(size_t* target, const std::string_view& long_name, const std::string_view& description)
+    : FlagBase{long_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+BoundFlagCount::BoundFlagCount(size_t* target, char short_name, const std::string_view& description)
+    : FlagBase{short_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+BoundFlagCount::BoundFlagCount(size_t* target, char short_name, const std::string_view& long_name,
+                               const std::string_view& description)
+    : FlagBase{short_name, long_name, description}
+    , target_{target}
+    , default_{*target} {
+}
+
+void BoundFlagCount::set_found() noexcept {
+    was_ = true;
+    *target_ += 1;
+}
+
+void BoundFlagCount::set_count(size_t count) noexcept {
+    was_ = count != 0;
+    *target_ = default_ + count;
+}
+
+bool BoundFlagCount::is_set() const noexcept {
+    return was_;
+}
+
+details::FlagVariant BoundFlagCount::typed_ref() noexcept {
+    return details::make_node_variant<details::FlagVariant>(this);
+}
+
+size_t BoundFlagCount::get_count() const noexcept {
+    return was_ ? *target_ - default_ : 0;
+}
+
+void BoundFlagCount::reset_to_default() noexcept {
+    was_ = false;
+    *target_ = default_;
+}
+
 }  // namespace xdx::cliopts
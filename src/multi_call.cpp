@@ -0,0 +1,80 @@
+#include <xdx/cliopts/multi_call.hpp>
+
+#include <stdexcept>
+
+namespace xdx::cliopts
+{
+
+MultiCall::MultiCall(std::string_view name)
+    : name_{name} {
+}
+
+MultiCall& MultiCall::add_tool(std::string_view name, std::string_view description, Factory factory) {
+    if (name.empty()) {
+        throw std::invalid_argument("tool name can't be empty");
+    }
+    if (index_.count(name) != 0) {
+        throw std::invalid_argument(std::string("dublicated tool name: '") + std::string(name) + "'");
+    }
+
+    auto tool = std::make_shared<LazyOptions>(name, description, std::move(factory));
+    index_.emplace(tool->get_name(), tools_.size());
+    tools_.emplace_back(std::move(tool));
+    return *this;
+}
+
+std::shared_ptr<LazyOptions> MultiCall::find_tool(std::string_view name) const noexcept {
+    const auto it = index_.find(name);
+    return it != index_.end() ? tools_[it->second] : nullptr;
+}
+
+MultiCall::Selection MultiCall::select(const Argv& argv) const {
+    if (auto tool = find_tool(basename(argv.cmd()))) {
+        return {std::move(tool), argv};
+    }
+
+    // links of other names aren't ours, so their first argument is never taken as tool
+    if (basename(argv.cmd()) == name_ && !argv.empty()) {
+        auto tool_argv = argv.shifted();
+        if (auto tool = find_tool(tool_argv.cmd())) {
+            return {std::move(tool), tool_argv};
+        }
+    }
+    return {nullptr, argv};
+}
+
+MultiCall::Result MultiCall::process(Argv&& argv, const Parser& parser, std::ostream& errout) const {
+    auto selection = select(argv);
+    if (!selection.tool) {
+        Result result;
+        Diagnostic diagnostic{DiagnosticId::UnknownTool, make_error_code(ProcessingArgumentsError::UnknownSubcommand),
+                              Diagnostic::NO_ARGV_INDEX, std::string(basename(argv.cmd())), {}, {}};
+        if (basename(argv.cmd()) == name_) {
+            // called by own name, tool is expected as the first argument
+            diagnostic.name = argv.empty() ? "" : argv[0];
+            diagnostic.argv_index = argv.empty() ? Diagnostic::NO_ARGV_INDEX : 0;
+        }
+        for (const auto& tool : tools_) {
+            diagnostic.related.emplace_back(tool->get_name());
+        }
+        result.parsed.error = diagnostic.error;
+        result.parsed.diagnostics.push_back(std::move(diagnostic));
+        if (parser.is_writing_diagnostics()) {
+            write_diagnostics(errout, result.parsed.diagnostics);
+        }
+        return result;
+    }
+
+    return {selection.tool, parser.rebind(selection.tool).process(std::move(selection.argv), errout)};
+}
+
+MultiCall::Result MultiCall::process(Argv&& argv, std::ostream& errout) const {
+    return process(std::move(argv), Parser(nullptr), errout);
+}
+
+std::string_view MultiCall::basename(std::string_view path) noexcept {
+    const auto slash = path.find_last_of("/\\");
+    return slash == path.npos ? path : path.substr(slash + 1);
+}
+
+}  // namespace xdx::cliopts
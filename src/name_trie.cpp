@@ -0,0 +1,107 @@
+#include <xdx/cliopts/details/name_trie.hpp>
+
+namespace xdx::cliopts::details
+{
+
+void NameTrie::insert(std::string_view name, size_t value) {
+    if (nodes_.empty()) {
+        nodes_.emplace_back();
+    }
+
+    // counts along the path are updated only for a new name
+    if (const auto existing = _walk(name); existing != NO_NODE && nodes_[existing].terminal) {
+        nodes_[existing].value = value;
+        return;
+    }
+
+    uint32_t node = 0;
+    nodes_[node].names_count += 1;
+    nodes_[node].value = value;
+    for (char ch : name) {
+        const auto label = static_cast<unsigned char>(ch);
+        auto child = _child(node, label);
+        if (child == NO_NODE) {
+            child = static_cast<uint32_t>(nodes_.size());
+            Node created;
+            created.label = label;
+            created.next_sibling = nodes_[node].first_child;
+            nodes_.push_back(created);
+            nodes_[node].first_child = child;
+        }
+        node = child;
+        nodes_[node].names_count += 1;
+        if (!nodes_[node].terminal) {
+            nodes_[node].value = value;
+        }
+    }
+    nodes_[node].terminal = true;
+    nodes_[node].value = value;
+    size_ += 1;
+}
+
+void NameTrie::reserve(size_t count, size_t length) {
+    nodes_.reserve(nodes_.size() + (length != 0 ? length : count) + 1);
+}
+
+void NameTrie::shrink_to_fit() {
+    nodes_.shrink_to_fit();
+}
+
+size_t NameTrie::size() const noexcept {
+    return size_;
+}
+
+bool NameTrie::empty() const noexcept {
+    return size_ == 0;
+}
+
+NameTrie::Match NameTrie::find(std::string_view name) const noexcept {
+    const auto node = _walk(name);
+    if (node == NO_NODE || !nodes_[node].terminal) {
+        return {};
+    }
+    return {1, nodes_[node].value};
+}
+
+NameTrie::Match NameTrie::find_prefix(std::string_view prefix) const noexcept {
+    // root is prefix of every name, so empty prefix would pick the only one
+    if (prefix.empty()) {
+        return {};
+    }
+
+    const auto node = _walk(prefix);
+    if (node == NO_NODE || nodes_[node].names_count == 0) {
+        return {};
+    }
+
+    if (nodes_[node].terminal || nodes_[node].names_count == 1) {
+        return {1, nodes_[node].value};
+    }
+
+    return {nodes_[node].names_count, NPOS};
+}
+
+uint32_t NameTrie::_child(uint32_t node, unsigned char label) const noexcept {
+    auto child = nodes_[node].first_child;
+    while (child != NO_NODE && nodes_[child].label != label) {
+        child = nodes_[child].next_sibling;
+    }
+    return child;
+}
+
+uint32_t NameTrie::_walk(std::string_view name) const noexcept {
+    if (nodes_.empty()) {
+        return NO_NODE;
+    }
+
+    uint32_t node = 0;
+    for (char ch : name) {
+        node = _child(node, static_cast<unsigned char>(ch));
+        if (node == NO_NODE) {
+            break;
+        }
+    }
+    return node;
+}
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,159 @@
+#include <xdx/cliopts/details/node_table.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace xdx::cliopts::details
+{
+
+void NodeTable::add(NodeKind kind, size_t index, char short_name, std::string_view long_name, bool required) {
+    // load factor is kept at most 1/2
+    if (!long_name.empty() && 2 * (long_names_count_ + 1) > long_slots_.size()) {
+        rehash(std::max<size_t>(16, 2 * long_slots_.size()));
+    }
+
+    const size_t entry = size();
+    hashes_.push_back(hash(long_name));
+    lengths_.push_back(static_cast<uint32_t>(long_name.size()));
+    names_.push_back(long_name.data());
+    kinds_.push_back(kind);
+    indexes_.push_back(static_cast<uint32_t>(index));
+    required_.set(entry, required);
+
+    if (short_name != '\0') {
+        assert(find(short_name) == NPOS && "names are checked for duplicates by options");
+        short_names_.push_back(short_name);
+        short_entries_.push_back(static_cast<uint32_t>(entry));
+    }
+
+    if (!long_name.empty()) {
+        insert_long(entry);
+        ++long_names_count_;
+    }
+}
+
+void NodeTable::reserve(size_t count) {
+    hashes_.reserve(count);
+    lengths_.reserve(count);
+    names_.reserve(count);
+    kinds_.reserve(count);
+    indexes_.reserve(count);
+    required_.reserve(count);
+    size_t slots = std::max<size_t>(16, long_slots_.size());
+    while (slots < 2 * count) {
+        slots *= 2;
+    }
+    if (slots > long_slots_.size()) {
+        rehash(slots);
+    }
+}
+
+void NodeTable::shrink_to_fit() {
+    hashes_.shrink_to_fit();
+    lengths_.shrink_to_fit();
+    names_.shrink_to_fit();
+    kinds_.shrink_to_fit();
+    indexes_.shrink_to_fit();
+    short_names_.shrink_to_fit();
+    short_entries_.shrink_to_fit();
+
+    size_t slots = 16;
+    while (slots < 2 * long_names_count_) {
+        slots *= 2;
+    }
+    if (slots < long_slots_.size()) {
+        rehash(slots);
+    }
+    long_slots_.shrink_to_fit();
+}
+
+size_t NodeTable::size() const noexcept {
+    return kinds_.size();
+}
+
+size_t NodeTable::find(char short_name) const noexcept {
+    if (short_name == '\0') {
+        return NPOS;
+    }
+
+    const auto* pos = static_cast<const char*>(std::memchr(short_names_.data(), short_name, short_names_.size()));
+    return pos ? short_entries_[pos - short_names_.data()] : NPOS;
+}
+
+size_t NodeTable::find(std::string_view long_name) const noexcept {
+    if (long_name.empty() || long_slots_.empty()) {
+        return NPOS;
+    }
+
+    const auto name_hash = hash(long_name);
+    const auto mask = long_slots_.size() - 1;
+    for (size_t slot = name_hash & mask; long_slots_[slot] != 0; slot = (slot + 1) & mask) {
+        const auto entry = long_slots_[slot] - 1;
+        if (hashes_[entry] == name_hash && lengths_[entry] == long_name.size() &&
+            std::memcmp(names_[entry], long_name.data(), long_name.size()) == 0) {
+            return entry;
+        }
+    }
+    return NPOS;
+}
+
+NodeKind NodeTable::kind(size_t entry) const noexcept {
+    return kinds_[entry];
+}
+
+size_t NodeTable::index(size_t entry) const noexcept {
+    return indexes_[entry];
+}
+
+bool NodeTable::is_flag(size_t entry) const noexcept {
+    return kinds_[entry] == NodeKind::Flag || kinds_[entry] == NodeKind::FlagCount;
+}
+
+void NodeTable::set_required(size_t entry, bool required) noexcept {
+    required_.set(entry, required);
+}
+
+void NodeTable::move_name(size_t entry, std::string_view long_name) noexcept {
+    assert(long_name.size() == lengths_[entry] && "name is moved, not changed");
+    names_[entry] = long_name.data();
+}
+
+std::vector<uint32_t> NodeTable::required_arguments() const {
+    std::vector<uint32_t> result;
+    for (size_t entry = required_.find(); entry != NodeBits::NPOS; entry = required_.find(entry + 1)) {
+        result.push_back(indexes_[entry]);
+    }
+    return result;
+}
+
+void NodeTable::rehash(size_t slots_count) {
+    long_slots_.assign(slots_count, 0);
+    for (size_t entry = 0; entry < size(); ++entry) {
+        if (lengths_[entry] != 0) {
+            insert_long(entry);
+        }
+    }
+}
+
+// linear probing, `long_slots_` always has free slot
+void NodeTable::insert_long(size_t entry) {
+    const auto mask = long_slots_.size() - 1;
+    size_t slot = hashes_[entry] & mask;
+    while (long_slots_[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    long_slots_[slot] = static_cast<uint32_t>(entry + 1);
+}
+
+// FNV-1a
+uint32_t NodeTable::hash(std::string_view name) noexcept {
+    uint32_t result = 2166136261u;
+    for (char ch : name) {
+        result ^= static_cast<unsigned char>(ch);
+        result *= 16777619u;
+    }
+    return result;
+}
+
+}  // namespace xdx::cliopts::details
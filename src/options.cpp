@@ -1,15 +1,70 @@
 #include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/error.hpp>
 #include <xdx/cliopts/flag.hpp>
 #include <xdx/cliopts/options.hpp>
 
 #include <algorithm>
+#include <stdexcept>
+#include <utility>
 
 namespace xdx::cliopts
 {
 
+namespace
+{
+
+Diagnostic missing_required(const iOptions::ArgumentPtr& argument) {
+    return {DiagnosticId::RequiredArgument, make_error_code(ProcessingArgumentsError::RequiredArgument),
+            Diagnostic::NO_ARGV_INDEX, details::switcher_name(argument), {}, {}};
+}
+
+}  // namespace
+
+FlagRef iOptions::find_flag_ref(char short_name) const {
+    return FlagRef::generic(find_flag(short_name).get());
+}
+
+FlagRef iOptions::find_flag_ref(std::string_view long_name) const {
+    return FlagRef::generic(find_flag(long_name).get());
+}
+
+ArgumentRef iOptions::find_argument_ref(char short_name) const {
+    return ArgumentRef::generic(find_argument(short_name).get());
+}
+
+ArgumentRef iOptions::find_argument_ref(std::string_view long_name) const {
+    return ArgumentRef::generic(find_argument(long_name).get());
+}
+
+ArgumentRef iOptions::get_argument_ref(size_t idx) const {
+    return ArgumentRef::generic(get_argument(idx).get());
+}
+
+size_t iOptions::find_missing_required(size_t from) const {
+    const size_t count = arguments_count();
+    for (size_t idx = from; idx < count; ++idx) {
+        const auto argument = get_argument_ref(idx);
+        if (argument.is_required() && !argument.has_value()) {
+            return idx;
+        }
+    }
+    return count;
+}
+
+std::error_code iOptions::check_provided(const details::NodeBits& /*provided*/, Diagnostics& diagnostics) const {
+    std::error_code error;
+    const auto arguments_count = this->arguments_count();
+    for (size_t idx = find_missing_required(0); idx < arguments_count; idx = find_missing_required(idx + 1)) {
+        diagnostics.push_back(missing_required(get_argument(idx)));
+        error = diagnostics.back().error;
+    }
+    return error;
+}
+
 Options::Options(const std::string_view& name, const std::string_view& description)
-    : name_{name}
-    , description_{description} {
+    : strings_{std::make_shared<details::StringPool>()}
+    , name_{strings_->intern(name)}
+    , description_{strings_->intern(description)} {
 }
 
 std::string_view Options::get_name() const noexcept {
@@ -45,15 +100,13 @@ Options::SubcommandPtr Options::get_subcommand(size_t idx) const noexcept {
 }
 
 Options::FlagPtr Options::find_flag(char short_name) const noexcept {
-    const auto it = std::find_if(flags_.begin(), flags_.end(),
-                                 [short_name](const auto& flag) { return flag->get_short_name() == short_name; });
-    return it != flags_.end() ? *it : nullptr;
+    const auto entry = nodes_.find(short_name);
+    return entry != details::NodeTable::NPOS && nodes_.is_flag(entry) ? flags_[nodes_.index(entry)] : nullptr;
 }
 
 Options::FlagPtr Options::find_flag(std::string_view long_name) const noexcept {
-    const auto it = std::find_if(flags_.begin(), flags_.end(),
-                                 [long_name](const auto& flag) { return flag->get_long_name() == long_name; });
-    return it != flags_.end() ? *it : nullptr;
+    const auto entry = nodes_.find(long_name);
+    return entry != details::NodeTable::NPOS && nodes_.is_flag(entry) ? flags_[nodes_.index(entry)] : nullptr;
 }
 
 Options::FlagCountPtr Options::find_flag_count(char short_name) const noexcept {
@@ -65,38 +118,196 @@ Options::FlagCountPtr Options::find_flag_count(std::string_view long_name) const
 }
 
 Options::ArgumentPtr Options::find_argument(char short_name) const noexcept {
-    const auto it = std::find_if(arguments_.begin(), arguments_.end(), [short_name](const auto& argument) {
-        return argument->get_short_name() == short_name;
-    });
-    return it != arguments_.end() ? *it : nullptr;
+    const auto entry = nodes_.find(short_name);
+    return entry != details::NodeTable::NPOS && !nodes_.is_flag(entry) ? arguments_[nodes_.index(entry)] : nullptr;
 }
 
 Options::ArgumentPtr Options::find_argument(std::string_view long_name) const noexcept {
-    const auto it = std::find_if(arguments_.begin(), arguments_.end(),
-                                 [long_name](const auto& argument) { return argument->get_long_name() == long_name; });
-    return it != arguments_.end() ? *it : nullptr;
+    const auto entry = nodes_.find(long_name);
+    return entry != details::NodeTable::NPOS && !nodes_.is_flag(entry) ? arguments_[nodes_.index(entry)] : nullptr;
+}
+
+std::tuple<size_t, Options::FlagPtr, Options::ArgumentPtr> Options::find_long_name_prefix(
+    std::string_view prefix) const {
+    const auto match = _long_names_index().find_prefix(prefix);
+    if (match.count != 1) {
+        return {match.count, nullptr, nullptr};
+    }
+
+    if (match.value % 2 == 0) {
+        return {1, flags_[match.value / 2], nullptr};
+    }
+    return {1, nullptr, arguments_[match.value / 2]};
 }
 
 Options::SubcommandPtr Options::find_subcommand(std::string_view name) const noexcept {
-    const auto it = std::find_if(subcommands_.begin(), subcommands_.end(),
-                                 [name](const auto& subcommand) { return subcommand->get_name() == name; });
-    return it != subcommands_.end() ? *it : nullptr;
+    const auto match = subcommands_index_.find(name);
+    return match.count != 0 ? subcommands_[match.value] : nullptr;
+}
+
+std::pair<size_t, Options::SubcommandPtr> Options::find_subcommand_prefix(std::string_view prefix) const noexcept {
+    const auto match = subcommands_index_.find_prefix(prefix);
+    return {match.count, match.count == 1 ? subcommands_[match.value] : nullptr};
+}
+
+FlagRef Options::find_flag_ref(char short_name) const noexcept {
+    const auto entry = nodes_.find(short_name);
+    return entry != details::NodeTable::NPOS && nodes_.is_flag(entry) ? flag_refs_[nodes_.index(entry)] : FlagRef{};
+}
+
+FlagRef Options::find_flag_ref(std::string_view long_name) const noexcept {
+    const auto entry = nodes_.find(long_name);
+    return entry != details::NodeTable::NPOS && nodes_.is_flag(entry) ? flag_refs_[nodes_.index(entry)] : FlagRef{};
+}
+
+ArgumentRef Options::find_argument_ref(char short_name) const noexcept {
+    const auto entry = nodes_.find(short_name);
+    return entry != details::NodeTable::NPOS && !nodes_.is_flag(entry) ? argument_refs_[nodes_.index(entry)]
+                                                                        : ArgumentRef{};
+}
+
+ArgumentRef Options::find_argument_ref(std::string_view long_name) const noexcept {
+    const auto entry = nodes_.find(long_name);
+    return entry != details::NodeTable::NPOS && !nodes_.is_flag(entry) ? argument_refs_[nodes_.index(entry)]
+                                                                        : ArgumentRef{};
+}
+
+ArgumentRef Options::get_argument_ref(size_t idx) const noexcept {
+    return argument_refs_[idx];
+}
+
+size_t Options::find_missing_required(size_t from) const noexcept {
+    if (!compiled_) {
+        return iOptions::find_missing_required(from);
+    }
+
+    for (auto it = std::lower_bound(required_arguments_.begin(), required_arguments_.end(), from);
+         it != required_arguments_.end(); ++it) {
+        if (!argument_refs_[*it].has_value()) {
+            return *it;
+        }
+    }
+    return arguments_.size();
+}
+
+std::error_code Options::check_provided(const details::NodeBits& provided, Diagnostics& diagnostics) const {
+    std::error_code error;
+    if (compiled_) {
+        const auto& required = nodes_.required();
+        for (size_t entry = required.find_not_in(provided); entry != details::NodeBits::NPOS;
+             entry = required.find_not_in(provided, entry + 1)) {
+            // value could be set before parsing
+            if (!argument_refs_[nodes_.index(entry)].has_value()) {
+                diagnostics.push_back(missing_required(arguments_[nodes_.index(entry)]));
+                error = diagnostics.back().error;
+            }
+        }
+    } else {
+        // required bits are refreshed only by compile()
+        error = iOptions::check_provided(provided, diagnostics);
+    }
+    if (error) {
+        return error;
+    }
+
+    for (size_t idx = constraints_.find_violated(provided); idx != details::Constraints::NPOS;
+         idx = constraints_.find_violated(provided, idx + 1)) {
+        const auto& constraint = constraints_.get(idx);
+        Diagnostic diagnostic;
+        switch (constraint.kind) {
+            case details::ConstraintKind::MutuallyExclusive: {
+                auto given = constraint.nodes;
+                for (size_t entry = given.find(); entry != details::NodeBits::NPOS; entry = given.find(entry + 1)) {
+                    given.set(entry, provided.test(entry));
+                }
+                diagnostic.id = DiagnosticId::MutuallyExclusive;
+                diagnostic.error = make_error_code(ProcessingArgumentsError::MutuallyExclusive);
+                diagnostic.related = _node_names(given);
+            } break;
+            case details::ConstraintKind::Requires: {
+                auto missing = constraint.nodes;
+                for (size_t entry = missing.find(); entry != details::NodeBits::NPOS; entry = missing.find(entry + 1)) {
+                    missing.set(entry, !provided.test(entry));
+                }
+                diagnostic.id = DiagnosticId::MissingDependency;
+                diagnostic.error = make_error_code(ProcessingArgumentsError::MissingDependency);
+                diagnostic.name = _node_name(constraint.trigger.find());
+                diagnostic.related = _node_names(missing);
+            } break;
+            case details::ConstraintKind::AtLeastOne:
+                diagnostic.id = DiagnosticId::AtLeastOneRequired;
+                diagnostic.error = make_error_code(ProcessingArgumentsError::AtLeastOneRequired);
+                diagnostic.related = _node_names(constraint.nodes);
+                break;
+        }
+        error = error ? error : diagnostic.error;
+        diagnostics.push_back(std::move(diagnostic));
+    }
+    return error;
+}
+
+void Options::add_mutually_exclusive(std::initializer_list<std::string_view> names) {
+    _assert_not_compiled();
+    constraints_.add({details::ConstraintKind::MutuallyExclusive, {}, _find_nodes(names)});
+}
+
+void Options::add_depends_on(std::string_view name, std::initializer_list<std::string_view> names) {
+    _assert_not_compiled();
+    details::NodeBits trigger;
+    trigger.set(_find_node(name));
+    constraints_.add({details::ConstraintKind::Requires, std::move(trigger), _find_nodes(names)});
+}
+
+void Options::add_at_least_one(std::initializer_list<std::string_view> names) {
+    _assert_not_compiled();
+    constraints_.add({details::ConstraintKind::AtLeastOne, {}, _find_nodes(names)});
+}
+
+void Options::reserve(size_t flags, size_t arguments, size_t subcommands) {
+    flags_.reserve(flags_.size() + flags);
+    flag_refs_.reserve(flags_.size() + flags);
+    arguments_.reserve(arguments_.size() + arguments);
+    argument_refs_.reserve(arguments_.size() + arguments);
+    nodes_.reserve(nodes_.size() + flags + arguments);
+    subcommands_.reserve(subcommands_.size() + subcommands);
+    subcommand_names_.reserve(subcommands_.size() + subcommands);
 }
 
 void Options::add(FlagPtr&& flag) {
+    _assert_not_compiled();
+    flag->attach_strings(strings_);
     _assert_short_name(flag->get_short_name());
     _assert_long_name(flag->get_long_name());
+    nodes_.add(flag->is_countable() ? details::NodeKind::FlagCount : details::NodeKind::Flag, flags_.size(),
+               flag->get_short_name(), flag->get_long_name(), false);
+    if (long_names_indexed_ && !flag->get_long_name().empty()) {
+        long_names_index_.insert(flag->get_long_name(), 2 * flags_.size());
+    }
+    flag_refs_.emplace_back(FlagRef::classify(flag.get()).at_node(nodes_.size() - 1));
     flags_.emplace_back(std::move(flag));
 }
 
 void Options::add(ArgumentPtr&& arg) {
+    _assert_not_compiled();
+    arg->attach_strings(strings_);
     _assert_short_name(arg->get_short_name());
     _assert_long_name(arg->get_long_name());
+    nodes_.add(arg->is_many_values() ? details::NodeKind::ArgumentList : details::NodeKind::Argument,
+               arguments_.size(), arg->get_short_name(), arg->get_long_name(), arg->is_required());
+    if (long_names_indexed_ && !arg->get_long_name().empty()) {
+        long_names_index_.insert(arg->get_long_name(), 2 * arguments_.size() + 1);
+    }
+    argument_refs_.emplace_back(ArgumentRef::classify(arg.get()).at_node(nodes_.size() - 1));
     arguments_.emplace_back(std::move(arg));
 }
 
 void Options::add(SubcommandPtr&& sub) {
+    _assert_not_compiled();
+    if (const auto options = dynamic_cast<Options*>(sub.get())) {
+        options->_share_strings(strings_);
+    }
     _assert_sub_name(sub->get_name());
+    subcommands_index_.insert(sub->get_name(), subcommands_.size());
     subcommands_.emplace_back(std::move(sub));
 }
 
@@ -114,51 +325,313 @@ void Options::reset_to_default() noexcept {
     }
 }
 
-void Options::_assert_short_name(char ch) {
-    if (ch == '\0') {
+void Options::compile() {
+    if (compiled_) {
         return;
     }
 
-    for (const auto& f : flags_) {
-        if (f->get_short_name() == ch) {
-            throw std::invalid_argument(std::string("dublicated short name: '") + std::string{ch} + "'");
+    // required-ness could be changed after argument was added
+    for (size_t entry = 0; entry < nodes_.size(); ++entry) {
+        if (!nodes_.is_flag(entry)) {
+            nodes_.set_required(entry, arguments_[nodes_.index(entry)]->is_required());
         }
     }
+    required_arguments_ = nodes_.required_arguments();
+
+    long_names_index_.shrink_to_fit();
+    subcommands_index_.shrink_to_fit();
+    nodes_.shrink_to_fit();
+    flags_.shrink_to_fit();
+    arguments_.shrink_to_fit();
+    subcommands_.shrink_to_fit();
+    flag_refs_.shrink_to_fit();
+    argument_refs_.shrink_to_fit();
+    constraints_.shrink_to_fit();
+    // only add() checks duplicates
+    subcommand_names_ = {};
 
-    for (const auto& a : arguments_) {
-        if (a->get_short_name() == ch) {
-            throw std::invalid_argument(std::string("dublicated short name: '") + std::string{ch} + "'");
-        }
+    for (auto& sub : subcommands_) {
+        sub->compile();
+    }
+    compiled_ = true;
+}
+
+bool Options::is_compiled() const noexcept {
+    return compiled_;
+}
+
+const details::StringPoolPtr& Options::get_strings() const noexcept {
+    return strings_;
+}
+
+void Options::_assert_short_name(char ch) {
+    if (nodes_.find(ch) != details::NodeTable::NPOS) {
+        throw std::invalid_argument(std::string("dublicated short name: '") + std::string{ch} + "'");
     }
 }
 
 void Options::_assert_long_name(const std::string_view& lname) {
-    if (lname.empty()) {
+    if (nodes_.find(lname) != details::NodeTable::NPOS) {
+        throw std::invalid_argument(std::string("dublicated long name: '") + std::string(lname) + "'");
+    }
+}
+
+void Options::_assert_not_compiled() {
+    if (compiled_) {
+        throw std::logic_error(std::string("options are compiled: '") + std::string(name_) + "'");
+    }
+}
+
+void Options::_assert_sub_name(const std::string_view& name) {
+    if (name.empty()) {
+        throw std::invalid_argument("subcommand name can't be empty");
+    }
+
+    if (!subcommand_names_.insert(name).second) {
+        throw std::invalid_argument(std::string("dublicated subcommand name: '") + std::string(name) + "'");
+    }
+}
+
+size_t Options::_find_node(std::string_view name) const {
+    auto entry = nodes_.find(name);
+    if (entry == details::NodeTable::NPOS && name.size() == 1) {
+        entry = nodes_.find(name[0]);
+    }
+    if (entry == details::NodeTable::NPOS) {
+        throw std::invalid_argument(std::string("unknown name in constraint: '") + std::string(name) + "'");
+    }
+    return entry;
+}
+
+details::NodeBits Options::_find_nodes(std::initializer_list<std::string_view> names) const {
+    details::NodeBits nodes;
+    for (auto name : names) {
+        nodes.set(_find_node(name));
+    }
+    return nodes;
+}
+
+std::string Options::_node_name(size_t entry) const {
+    if (nodes_.is_flag(entry)) {
+        return details::switcher_name(flags_[nodes_.index(entry)]);
+    }
+    return details::switcher_name(arguments_[nodes_.index(entry)]);
+}
+
+std::vector<std::string> Options::_node_names(const details::NodeBits& nodes) const {
+    std::vector<std::string> names;
+    for (size_t entry = nodes.find(); entry != details::NodeBits::NPOS; entry = nodes.find(entry + 1)) {
+        names.push_back(_node_name(entry));
+    }
+    return names;
+}
+
+void Options::_share_strings(const details::StringPoolPtr& pool) {
+    if (strings_ == pool) {
         return;
     }
 
-    for (const auto& f : flags_) {
-        if (f->get_long_name() == lname) {
-            throw std::invalid_argument(std::string("dublicated long name: '") + std::string(lname) + "'");
+    // old pool is kept until everything is copied out of it
+    const auto old_strings = std::exchange(strings_, pool);
+    name_ = strings_->intern(name_);
+    description_ = strings_->intern(description_);
+
+    for (const auto& flag : flags_) {
+        flag->attach_strings(strings_);
+    }
+
+    for (const auto& arg : arguments_) {
+        arg->attach_strings(strings_);
+    }
+
+    for (size_t entry = 0; entry < nodes_.size(); ++entry) {
+        const auto index = nodes_.index(entry);
+        nodes_.move_name(entry, nodes_.is_flag(entry) ? flags_[index]->get_long_name()
+                                                      : arguments_[index]->get_long_name());
+    }
+
+    for (const auto& sub : subcommands_) {
+        if (const auto options = dynamic_cast<Options*>(sub.get())) {
+            options->_share_strings(strings_);
         }
     }
 
-    for (const auto& a : arguments_) {
-        if (a->get_long_name() == lname) {
-            throw std::invalid_argument(std::string("dublicated long name: '") + std::string(lname) + "'");
+    // names of subcommands could be moved
+    if (!subcommand_names_.empty()) {
+        subcommand_names_.clear();
+        for (const auto& sub : subcommands_) {
+            subcommand_names_.insert(sub->get_name());
         }
     }
 }
 
-void Options::_assert_sub_name(const std::string_view& name) {
-    if (name.empty()) {
-        throw std::invalid_argument("subcommand name can't be empty");
+const details::NameTrie& Options::_long_names_index() const {
+    std::call_once(long_names_once_, [this]() {
+        for (size_t idx = 0; idx < flags_.size(); ++idx) {
+            if (!flags_[idx]->get_long_name().empty()) {
+                long_names_index_.insert(flags_[idx]->get_long_name(), 2 * idx);
+            }
+        }
+
+        for (size_t idx = 0; idx < arguments_.size(); ++idx) {
+            if (!arguments_[idx]->get_long_name().empty()) {
+                long_names_index_.insert(arguments_[idx]->get_long_name(), 2 * idx + 1);
+            }
+        }
+        long_names_indexed_ = true;
+    });
+    return long_names_index_;
+}
+
+LazyOptions::LazyOptions(const std::string_view& name, const std::string_view& description, Factory factory)
+    : name_{name}
+    , description_{description}
+    , factory_{std::move(factory)} {
+    if (!factory_) {
+        throw std::invalid_argument(std::string("subcommand factory is empty: '") + name_ + "'");
+    }
+}
+
+std::string_view LazyOptions::get_name() const noexcept {
+    return name_;
+}
+
+std::string_view LazyOptions::get_description() const noexcept {
+    return description_;
+}
+
+size_t LazyOptions::flags_count() const {
+    return materialize()->flags_count();
+}
+
+size_t LazyOptions::arguments_count() const {
+    return materialize()->arguments_count();
+}
+
+size_t LazyOptions::subcommands_count() const {
+    return materialize()->subcommands_count();
+}
+
+LazyOptions::FlagPtr LazyOptions::get_flag(size_t idx) const {
+    return materialize()->get_flag(idx);
+}
+
+LazyOptions::ArgumentPtr LazyOptions::get_argument(size_t idx) const {
+    return materialize()->get_argument(idx);
+}
+
+LazyOptions::SubcommandPtr LazyOptions::get_subcommand(size_t idx) const {
+    return materialize()->get_subcommand(idx);
+}
+
+void LazyOptions::add(FlagPtr&& flag) {
+    materialize()->add(std::move(flag));
+}
+
+void LazyOptions::add(ArgumentPtr&& arg) {
+    materialize()->add(std::move(arg));
+}
+
+void LazyOptions::add(SubcommandPtr&& sub) {
+    materialize()->add(std::move(sub));
+}
+
+LazyOptions::FlagPtr LazyOptions::find_flag(char short_name) const {
+    return materialize()->find_flag(short_name);
+}
+
+LazyOptions::FlagPtr LazyOptions::find_flag(std::string_view long_name) const {
+    return materialize()->find_flag(long_name);
+}
+
+LazyOptions::FlagCountPtr LazyOptions::find_flag_count(char short_name) const {
+    return materialize()->find_flag_count(short_name);
+}
+
+LazyOptions::FlagCountPtr LazyOptions::find_flag_count(std::string_view long_name) const {
+    return materialize()->find_flag_count(long_name);
+}
+
+LazyOptions::ArgumentPtr LazyOptions::find_argument(char short_name) const {
+    return materialize()->find_argument(short_name);
+}
+
+LazyOptions::ArgumentPtr LazyOptions::find_argument(std::string_view long_name) const {
+    return materialize()->find_argument(long_name);
+}
+
+LazyOptions::SubcommandPtr LazyOptions::find_subcommand(std::string_view name) const {
+    return materialize()->find_subcommand(name);
+}
+
+std::tuple<size_t, LazyOptions::FlagPtr, LazyOptions::ArgumentPtr> LazyOptions::find_long_name_prefix(
+    std::string_view prefix) const {
+    return materialize()->find_long_name_prefix(prefix);
+}
+
+std::pair<size_t, LazyOptions::SubcommandPtr> LazyOptions::find_subcommand_prefix(
+    std::string_view prefix) const {
+    return materialize()->find_subcommand_prefix(prefix);
+}
+
+FlagRef LazyOptions::find_flag_ref(char short_name) const {
+    return materialize()->find_flag_ref(short_name);
+}
+
+FlagRef LazyOptions::find_flag_ref(std::string_view long_name) const {
+    return materialize()->find_flag_ref(long_name);
+}
+
+ArgumentRef LazyOptions::find_argument_ref(char short_name) const {
+    return materialize()->find_argument_ref(short_name);
+}
+
+ArgumentRef LazyOptions::find_argument_ref(std::string_view long_name) const {
+    return materialize()->find_argument_ref(long_name);
+}
+
+ArgumentRef LazyOptions::get_argument_ref(size_t idx) const {
+    return materialize()->get_argument_ref(idx);
+}
+
+size_t LazyOptions::find_missing_required(size_t from) const {
+    return materialize()->find_missing_required(from);
+}
+
+std::error_code LazyOptions::check_provided(const details::NodeBits& provided, Diagnostics& diagnostics) const {
+    return materialize()->check_provided(provided, diagnostics);
+}
+
+void LazyOptions::compile() {
+    compiled_ = true;
+    if (options_) {
+        options_->compile();
     }
+}
 
-    for (const auto& s : subcommands_) {
-        if (s->get_name() == name) {
-            throw std::invalid_argument(std::string("dublicated subcommand name: '") + std::string(name) + "'");
+void LazyOptions::reset_to_default() noexcept {
+    // nothing could be set in options which were never built
+    if (options_) {
+        options_->reset_to_default();
+    }
+}
+
+bool LazyOptions::is_materialized() const noexcept {
+    return options_ != nullptr;
+}
+
+const OptionsPtr& LazyOptions::materialize() const {
+    if (!options_) {
+        options_ = factory_();
+        if (!options_) {
+            throw std::logic_error(std::string("subcommand factory returned nothing: '") + name_ + "'");
+        }
+        factory_ = nullptr;
+        if (compiled_) {
+            options_->compile();
         }
     }
+    return options_;
 }
+
 }  // namespace xdx::cliopts
@@ -4,125 +4,269 @@
 #include <xdx/cliopts/tokenizer.hpp>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace xdx::cliopts
 {
 
 Parser::ProcessResult Parser::process(Argv&& argv, std::ostream& errout) {
-    ProcessResult result;
+    auto result = _process(argv, nullptr);
+    if (write_diagnostics_) {
+        cliopts::write_diagnostics(errout, result.diagnostics);
+    }
+    return result;
+}
 
-    Options::SubcommandPtr current_command = options_;
-    Tokenizer tokenizer(argv);
+Parser::ProcessResult Parser::process_pass_through(int& argc, const char** argv, std::ostream& errout) {
+    Argv view(argc, argv);
+    std::vector<bool> passed(view.size(), false);
 
-    Options::ArgumentPtr current_argument;
+    auto result = _process(view, &passed);
+    if (result.error) {
+        if (write_diagnostics_) {
+            cliopts::write_diagnostics(errout, result.diagnostics);
+        }
+        return result;
+    }
 
-    bool not_end = false;
-    Tokenizer::Token token;
+    view.compact([&passed](size_t idx) { return passed[idx]; });
 
-    auto output_argument = [&errout](const auto& arg) {
-        if (!arg->get_long_name().empty()) {
-            errout << "'--" << arg->get_long_name() << '\'';
-        } else {
-            errout << "'-" << arg->get_short_name() << '\'';
+    const int original_argc = argc;
+    argc = static_cast<int>(view.size()) + (argc > 0 ? 1 : 0);
+    if (argc < original_argc) {
+        argv[argc] = nullptr;
+    }
+    return result;
+}
+
+Parser::ProcessResult Parser::process_stream(RecordReader& reader, Callbacks callbacks, std::ostream& errout) {
+    if (!callbacks.positional) {
+        // records are overwritten by the next read, so positionals can't be collected into the result
+        throw std::invalid_argument("positional callback is required to process stream");
+    }
+
+    // drained lists have no values left, so required ones are checked only by bits of compiled options
+    options_->compile();
+    Session session(*this, std::move(callbacks));
+
+    for (auto [not_end, record] = reader.next(); not_end; std::tie(not_end, record) = reader.next()) {
+        const char* entries[] = {"", record};
+        Argv argv(2, entries);
+        Tokenizer tokenizer(argv);
+
+        bool fed = true;
+        bool token_not_end = false;
+        Tokenizer::Token token;
+        for (std::tie(token_not_end, token) = tokenizer.next(); fed && token_not_end;
+             std::tie(token_not_end, token) = tokenizer.next()) {
+            fed = session.feed(token, reader.index());
+        }
+        if (!fed) {
+            break;
         }
-    };
+    }
+
+    auto result = session.finish();
+    if (write_diagnostics_) {
+        cliopts::write_diagnostics(errout, result.diagnostics);
+    }
+    return result;
+}
 
+Parser::ProcessResult Parser::_process(Argv& argv, std::vector<bool>* passed) {
+    Session session(*this, {}, passed);
+    Tokenizer tokenizer(argv);
+
+    bool not_end = false;
+    Tokenizer::Token token;
     for (std::tie(not_end, token) = tokenizer.next(); not_end; std::tie(not_end, token) = tokenizer.next()) {
-        assert(token.type != Tokenizer::TokenType::Unknown && "must be here");
-
-        if (current_argument && token.type != Tokenizer::TokenType::None) {
-            errout << "Argument ";
-            output_argument(current_argument);
-            errout << " expected value" << std::endl;
-            result.error = make_error_code(ProcessingArgumentsError::ExpectingValue);
-            return result;
+        if (!session.feed(token, tokenizer.entry())) {
+            break;
         }
+    }
+    return session.finish();
+}
+
+Parser::Session::Session(const Parser& parser, Callbacks callbacks, std::vector<bool>* passed)
+    : parser_{parser}
+    , callbacks_{std::move(callbacks)}
+    , passed_{passed}
+    , current_command_{parser.options_} {
+}
 
-        switch (token.type) {
-            case Tokenizer::TokenType::Short: {
-                auto flag = current_command->find_flag(token.get_short());
-                if (flag) {
-                    flag->set_found();
-                } else {
-                    auto argument = current_command->find_argument(token.get_short());
-                    if (argument) {
-                        current_argument = argument;
-                    } else {
-                        errout << "Unknown switcher: '-" << token.get_short() << "'" << std::endl;
-                        result.error = make_error_code(ProcessingArgumentsError::UnknonwSwitcher);
-                        return result;
+Diagnostic* Parser::Session::_report(DiagnosticId id, ProcessingArgumentsError error, size_t entry,
+                                     std::string name) {
+    result_.diagnostics.push_back({id, make_error_code(error), entry, std::move(name), {}, {}});
+    result_.error = result_.diagnostics.front().error;
+    return &result_.diagnostics.back();
+}
+
+void Parser::Session::_mark_provided(size_t node) {
+    if (node != NO_NODE) {
+        provided_.set(node);
+    }
+}
+
+bool Parser::Session::feed(const Tokenizer::Token& token, size_t entry) {
+    assert(token.type != Tokenizer::TokenType::Unknown && "must be here");
+    assert(!result_.error && "input must not be fed after error");
+
+    if (current_argument_ && token.type != Tokenizer::TokenType::None) {
+        _report(DiagnosticId::ExpectedValue, ProcessingArgumentsError::ExpectingValue, current_argument_entry_,
+                details::switcher_name(current_argument_));
+        return false;
+    }
+
+    switch (token.type) {
+        case Tokenizer::TokenType::Short: {
+            auto flag = current_command_->find_flag_ref(token.get_short());
+            auto argument = flag ? ArgumentRef{} : current_command_->find_argument_ref(token.get_short());
+            // a group like `-vx` can't be passed through in part, so it's either all known or all unknown
+            const bool partial_group =
+                passed_ && ((flag || argument) ? (*passed_)[entry] : known_short_entry_ == entry);
+            if (partial_group || (!flag && !argument && !passed_)) {
+                const char unknown = (flag || argument) ? passed_short_ : token.get_short();
+                _report(DiagnosticId::UnknownSwitcher, ProcessingArgumentsError::UnknonwSwitcher, entry,
+                        std::string("-") + unknown);
+                return false;
+            }
+
+            if (flag) {
+                flag.set_found();
+                _mark_provided(flag.node());
+                known_short_entry_ = entry;
+            } else if (argument) {
+                current_argument_ = argument;
+                current_argument_entry_ = entry;
+                known_short_entry_ = entry;
+            } else {
+                (*passed_)[entry] = true;
+                passed_short_ = token.get_short();
+            }
+        } break;
+        case Tokenizer::TokenType::Long: {
+            auto flag = current_command_->find_flag_ref(token.get_long());
+            auto argument = flag ? ArgumentRef{} : current_command_->find_argument_ref(token.get_long());
+            if (!flag && !argument && parser_.long_abbreviations_ && !token.get_long().empty()) {
+                auto [matches, prefix_flag, prefix_argument] =
+                    current_command_->find_long_name_prefix(token.get_long());
+                // looked up again by full name to get refs bound to node table
+                flag = prefix_flag ? current_command_->find_flag_ref(prefix_flag->get_long_name()) : FlagRef{};
+                argument = prefix_argument ? current_command_->find_argument_ref(prefix_argument->get_long_name())
+                                           : ArgumentRef{};
+                if (matches > 1) {
+                    auto* diagnostic = _report(DiagnosticId::AmbiguousSwitcher,
+                                               ProcessingArgumentsError::AmbiguousSwitcher, entry,
+                                               "--" + std::string(token.get_long()));
+                    auto add_candidate = [diagnostic, &token](const auto& source) {
+                        const auto name = source->get_long_name();
+                        if (!name.empty() && name.substr(0, token.get_long().size()) == token.get_long()) {
+                            diagnostic->related.push_back("--" + std::string(name));
+                        }
+                    };
+                    for (size_t fidx = 0; fidx < current_command_->flags_count(); ++fidx) {
+                        add_candidate(current_command_->get_flag(fidx));
                     }
-                }
-            } break;
-            case Tokenizer::TokenType::Long: {
-                auto flag = current_command->find_flag(token.get_long());
-                if (flag) {
-                    flag->set_found();
-                } else {
-                    auto argument = current_command->find_argument(token.get_long());
-                    if (argument) {
-                        current_argument = argument;
-                    } else {
-                        errout << "Unknown switcher: '-" << token.get_short() << "'" << std::endl;
-                        result.error = make_error_code(ProcessingArgumentsError::UnknonwSwitcher);
-                        return result;
+                    for (size_t aidx = 0; aidx < current_command_->arguments_count(); ++aidx) {
+                        add_candidate(current_command_->get_argument(aidx));
                     }
+                    return false;
                 }
-            } break;
-            case Tokenizer::TokenType::None: {
-                if (current_argument) {
-                    auto [success, error_message] = current_argument->set_string_value(token.get_long());
-                    if (!success) {
-                        errout << error_message << std::endl;
-                        result.error = make_error_code(ProcessingArgumentsError::WrongValueType);
-                        return result;
-                    }
-                    current_argument.reset();
-                } else {
-                    auto command = current_command->find_subcommand(token.get_long());
-                    if (!command) {
-                        result.unparsed_arguments.emplace_back(token.get_long());
-                    }
+            }
 
-                    if (!result.unparsed_arguments.empty()) {
-                        result.unparsed_arguments.emplace_back(token.get_long());
-                        continue;
-                    }
+            if (flag) {
+                flag.set_found();
+                _mark_provided(flag.node());
+            } else if (argument) {
+                current_argument_ = argument;
+                current_argument_entry_ = entry;
+            } else if (passed_) {
+                (*passed_)[entry] = true;
+            } else {
+                _report(DiagnosticId::UnknownSwitcher, ProcessingArgumentsError::UnknonwSwitcher, entry,
+                        "--" + std::string(token.get_long()));
+                return false;
+            }
+        } break;
+        case Tokenizer::TokenType::None:
+            return _feed_value(token, entry);
+        case Tokenizer::TokenType::Unknown:
+            break;
+    }
+    return true;
+}
 
-                    for (size_t aidx = 0; aidx < current_command->arguments_count(); ++aidx) {
-                        const auto argument = current_command->get_argument(aidx);
-                        if (argument->is_required() && !argument->has_value()) {
-                            errout << "Argument ";
-                            output_argument(argument);
-                            errout << " required value" << std::endl;
-                            result.error = make_error_code(ProcessingArgumentsError::RequiredArgument);
-                        }
-                    }
+bool Parser::Session::_feed_value(const Tokenizer::Token& token, size_t entry) {
+    if (passed_ && (*passed_)[entry]) {
+        // inline value of passed through switch, e.g. `--unknown=value`
+        return true;
+    }
 
-                    if (result.error) {
-                        return result;
-                    }
+    if (current_argument_) {
+        auto [success, error_message] = current_argument_.set_string_value(token.get_long());
+        if (!success) {
+            _report(DiagnosticId::WrongValue, ProcessingArgumentsError::WrongValueType, entry,
+                    details::switcher_name(current_argument_))
+                ->message = std::move(error_message);
+            return false;
+        }
+        _mark_provided(current_argument_.node());
+        if (callbacks_.value) {
+            callbacks_.value(*current_argument_.get());
+            if (current_argument_->is_many_values()) {
+                current_argument_->reset_to_default();
+            }
+        }
+        current_argument_ = {};
+        return true;
+    }
 
-                    result.subcommand_path.push_back(token.get_long());
-                    current_command = command;
+    auto command = current_command_->find_subcommand(token.get_long());
+    if (!command && parser_.subcommand_abbreviations_ && !positional_seen_ && !token.get_long().empty()) {
+        size_t matches = 0;
+        std::tie(matches, command) = current_command_->find_subcommand_prefix(token.get_long());
+        if (matches > 1) {
+            auto* diagnostic = _report(DiagnosticId::AmbiguousSubcommand, ProcessingArgumentsError::AmbiguousSubcommand,
+                                       entry, std::string(token.get_long()));
+            for (size_t sidx = 0; sidx < current_command_->subcommands_count(); ++sidx) {
+                const auto name = current_command_->get_subcommand(sidx)->get_name();
+                if (name.substr(0, token.get_long().size()) == token.get_long()) {
+                    diagnostic->related.emplace_back(name);
                 }
-            } break;
-            case Tokenizer::TokenType::Unknown:
-                continue;
+            }
+            return false;
         }
     }
 
-    for (size_t aidx = 0; aidx < current_command->arguments_count(); ++aidx) {
-        const auto argument = current_command->get_argument(aidx);
-        if (argument->is_required() && !argument->has_value()) {
-            errout << "Argument ";
-            output_argument(argument);
-            errout << " required value" << std::endl;
-            result.error = make_error_code(ProcessingArgumentsError::RequiredArgument);
+    if (!command || positional_seen_) {
+        positional_seen_ = true;
+        if (callbacks_.positional) {
+            callbacks_.positional(token.get_long());
+        } else {
+            result_.unparsed_arguments.emplace_back(token.get_long());
         }
+        if (passed_) {
+            (*passed_)[entry] = true;
+        }
+        return true;
     }
 
-    return result;
+    result_.error = current_command_->check_provided(provided_, result_.diagnostics);
+    if (result_.error) {
+        return false;
+    }
+    provided_.clear();
+
+    result_.subcommand_path.push_back(command->get_name());
+    current_command_ = command;
+    return true;
+}
+
+Parser::ProcessResult Parser::Session::finish() {
+    if (!result_.error) {
+        result_.error = current_command_->check_provided(provided_, result_.diagnostics);
+    }
+    return std::move(result_);
 }
 
 }  // namespace xdx::cliopts
@@ -0,0 +1,123 @@
+#include <xdx/cliopts/details/perfect_hash.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace xdx::cliopts::details
+{
+
+namespace
+{
+
+constexpr uint32_t MAX_SEED = 1u << 16;
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+PerfectHash::PerfectHash(const std::vector<std::string_view>& keys)
+    : keys_(keys.begin(), keys.end()) {
+    auto sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    const auto duplicate = std::adjacent_find(sorted.begin(), sorted.end());
+    if (duplicate != sorted.end()) {
+        throw std::invalid_argument("Duplicated key: '" + std::string(*duplicate) + "'");
+    }
+
+    if (keys_.empty()) {
+        return;
+    }
+
+    // load factor stays below 1 in case of unlucky keys, so build always terminates
+    for (size_t slots = round_up_pow2(keys_.size()); !build(slots); slots <<= 1) {
+    }
+}
+
+size_t PerfectHash::find(std::string_view key) const noexcept {
+    if (keys_.empty()) {
+        return NPOS;
+    }
+
+    const auto bucket = hash(key, 0) % seeds_.size();
+    const auto slot = hash(key, seeds_[bucket]) & (slots_.size() - 1);
+    const auto index = slots_[slot];
+    if (index == 0 || keys_[index - 1] != key) {
+        return NPOS;
+    }
+    return index - 1;
+}
+
+// FNV-1a with seeded basis and murmur3 finalizer, so low bits used as slot depend on every char
+uint32_t PerfectHash::hash(std::string_view key, uint32_t seed) noexcept {
+    uint32_t result = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char ch : key) {
+        result ^= static_cast<unsigned char>(ch);
+        result *= 16777619u;
+    }
+    result ^= result >> 16;
+    result *= 0x85ebca6bu;
+    result ^= result >> 13;
+    result *= 0xc2b2ae35u;
+    result ^= result >> 16;
+    return result;
+}
+
+bool PerfectHash::build(size_t slots_count) {
+    const size_t buckets_count = (keys_.size() + 3) / 4;
+    std::vector<std::vector<uint32_t>> buckets(buckets_count);
+    for (uint32_t index = 0; index < keys_.size(); ++index) {
+        buckets[hash(keys_[index], 0) % buckets_count].push_back(index);
+    }
+
+    // largest buckets first, while most of slots are still free
+    std::vector<size_t> order(buckets_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t lhs, size_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+    seeds_.assign(buckets_count, 0);
+    slots_.assign(slots_count, 0);
+    const auto mask = slots_count - 1;
+    std::vector<size_t> taken;
+
+    for (auto bucket : order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+
+        uint32_t seed = 1;
+        for (; seed < MAX_SEED; ++seed) {
+            taken.clear();
+            for (auto index : buckets[bucket]) {
+                const auto slot = hash(keys_[index], seed) & mask;
+                if (slots_[slot] != 0 || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+                    break;
+                }
+                taken.push_back(slot);
+            }
+            if (taken.size() == buckets[bucket].size()) {
+                break;
+            }
+        }
+
+        if (seed == MAX_SEED) {
+            return false;
+        }
+
+        seeds_[bucket] = seed;
+        for (size_t i = 0; i < taken.size(); ++i) {
+            slots_[taken[i]] = buckets[bucket][i] + 1;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace xdx::cliopts::details
@@ -24,7 +24,7 @@ void short_print_name(std::ostream& out, const Source& source) {
 void short_print_flag(std::ostream& out, const iOptions::FlagPtr& flag) {
     out << '[';
     short_print_name(out, flag);
-    if (std::dynamic_pointer_cast<const FlagCount>(flag) != nullptr) {
+    if (flag->is_countable()) {
         out << '|';
         short_print_name(out, flag);
         out << "...";
@@ -33,16 +33,34 @@ void short_print_flag(std::ostream& out, const iOptions::FlagPtr& flag) {
     out << ' ';
 }
 
+// allowed values replace type name, e.g. `--mode {fast|safe}`
+void short_print_value(std::ostream& out, const iOptions::ArgumentPtr& argument) {
+    out << ' ';
+    if (argument->allowed_values_count() == 0) {
+        out << argument->get_type_name();
+        return;
+    }
+
+    out << '{';
+    for (size_t i = 0; i < argument->allowed_values_count(); ++i) {
+        if (i != 0) {
+            out << '|';
+        }
+        out << argument->get_allowed_value(i);
+    }
+    out << '}';
+}
+
 void short_print_argument(std::ostream& out, const iOptions::ArgumentPtr& argument) {
     if (!argument->is_required()) {
         out << '[';
     }
     short_print_name(out, argument);
-    out << ' ' << argument->get_type_name();
+    short_print_value(out, argument);
     if (argument->is_many_values()) {
         out << '|';
         short_print_name(out, argument);
-        out << ' ' << argument->get_type_name();
+        short_print_value(out, argument);
         out << "...";
     }
     if (!argument->is_required()) {
@@ -225,6 +243,14 @@ struct LongNamePrint
             print_shift(1);
             print_description(argument->get_description(), description_width, description_shift);
             new_line();
+            if (argument->allowed_values_count() != 0) {
+                print_shift(description_shift);
+                out << "values: ";
+                for (size_t vidx = 0; vidx < argument->allowed_values_count(); ++vidx) {
+                    out << (vidx != 0 ? ", " : "") << argument->get_allowed_value(vidx);
+                }
+                new_line();
+            }
             if (argument->has_default_value()) {
                 print_shift(description_shift);
                 out << "default: " << argument->get_default_value();
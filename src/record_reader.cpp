@@ -0,0 +1,76 @@
+#include <xdx/cliopts/record_reader.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace xdx::cliopts
+{
+
+RecordReader::RecordReader(int fd, char delimiter, size_t chunk_size)
+    : fd_{fd}
+    , delimiter_{delimiter}
+    // one extra byte for terminator of the last record
+    , buffer_(chunk_size + 1) {
+}
+
+std::pair<bool, const char*> RecordReader::next() {
+    size_t scanned = begin_;
+    for (;;) {
+        auto* found = static_cast<char*>(std::memchr(buffer_.data() + scanned, delimiter_, end_ - scanned));
+        if (found) {
+            *found = '\0';
+            const char* record = buffer_.data() + begin_;
+            begin_ = static_cast<size_t>(found - buffer_.data()) + 1;
+            index_ += 1;
+            return {true, record};
+        }
+        scanned = end_ - begin_;
+
+        if (eof_ || !_fill()) {
+            break;
+        }
+    }
+
+    if (begin_ == end_) {
+        return {false, nullptr};
+    }
+
+    buffer_[end_] = '\0';
+    const char* record = buffer_.data() + begin_;
+    begin_ = end_;
+    index_ += 1;
+    return {true, record};
+}
+
+bool RecordReader::_fill() {
+    // partial record is moved to the front, so only record longer than buffer makes it grow
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ + 1 == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+
+    for (;;) {
+        const auto read = ::read(fd_, buffer_.data() + end_, buffer_.size() - 1 - end_);
+        if (read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "can't read records");
+        }
+        if (read == 0) {
+            eof_ = true;
+            return false;
+        }
+        end_ += static_cast<size_t>(read);
+        return true;
+    }
+}
+
+}  // namespace xdx::cliopts
@@ -0,0 +1,1105 @@
+#include <xdx/cliopts/schema.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+constexpr char SCHEMA_MAGIC[4] = {'X', 'D', 'X', 'S'};
+constexpr uint32_t SCHEMA_VERSION = 2;
+
+struct StringRef
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+// blob layout: Header, NodeRecord[nodes_count], FlagRecord[flags_count], ArgumentRecord[arguments_count],
+// uint32_t[subcommands_count], NameEntry[subcommands_count], ShortEntry[short_entries_count],
+// NameEntry[long_entries_count], StringRef[allowed_values_count], char[strings_size]
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t nodes_count;
+    uint32_t flags_count;
+    uint32_t arguments_count;
+    uint32_t subcommands_count;
+    uint32_t short_entries_count;
+    uint32_t long_entries_count;
+    uint32_t allowed_values_count;
+    uint32_t strings_size;
+};
+
+// Name indexes of node are sorted by name. Subcommand names are stored at the same positions as
+// subcommands themselves.
+struct NodeRecord
+{
+    StringRef name;
+    StringRef description;
+    uint32_t first_flag;
+    uint32_t flags_count;
+    uint32_t first_argument;
+    uint32_t arguments_count;
+    uint32_t first_subcommand;
+    uint32_t subcommands_count;
+    uint32_t first_short_entry;
+    uint32_t short_entries_count;
+    uint32_t first_long_entry;
+    uint32_t long_entries_count;
+};
+
+struct FlagRecord
+{
+    StringRef long_name;
+    StringRef description;
+    uint8_t short_name;
+    uint8_t countable;
+    uint8_t reserved[2];
+};
+
+struct ArgumentRecord
+{
+    StringRef long_name;
+    StringRef description;
+    StringRef type_name;
+    StringRef default_value;
+    uint32_t first_allowed_value;
+    uint32_t allowed_values_count;
+    uint8_t short_name;
+    uint8_t kind;
+    uint8_t attributes;
+    uint8_t delimiter;
+    uint8_t escape;
+    uint8_t reserved[3];
+};
+
+// flag `i` of node is stored as `2 * i`, argument `i` as `2 * i + 1`, subcommand `i` as `i`
+struct NameEntry
+{
+    StringRef name;
+    uint32_t value;
+};
+
+struct ShortEntry
+{
+    uint8_t short_name;
+    uint8_t reserved[3];
+    uint32_t value;
+};
+
+enum ArgumentAttributes : uint8_t
+{
+    REQUIRED = 1 << 0,
+    MANY_VALUES = 1 << 1,
+    HAS_DEFAULT = 1 << 2,
+};
+
+static_assert(sizeof(Header) % alignof(uint32_t) == 0);
+static_assert(sizeof(NodeRecord) % alignof(uint32_t) == 0);
+static_assert(sizeof(FlagRecord) % alignof(uint32_t) == 0);
+static_assert(sizeof(ArgumentRecord) % alignof(uint32_t) == 0);
+static_assert(sizeof(NameEntry) % alignof(uint32_t) == 0);
+static_assert(sizeof(ShortEntry) % alignof(uint32_t) == 0);
+
+template <class ValueType>
+constexpr SchemaValueKind kind_of() {
+    if constexpr (std::is_same_v<ValueType, short>) {
+        return SchemaValueKind::Short;
+    } else if constexpr (std::is_same_v<ValueType, unsigned short>) {
+        return SchemaValueKind::UShort;
+    } else if constexpr (std::is_same_v<ValueType, int>) {
+        return SchemaValueKind::Int;
+    } else if constexpr (std::is_same_v<ValueType, unsigned int>) {
+        return SchemaValueKind::UInt;
+    } else if constexpr (std::is_same_v<ValueType, long>) {
+        return SchemaValueKind::Long;
+    } else if constexpr (std::is_same_v<ValueType, unsigned long>) {
+        return SchemaValueKind::ULong;
+    } else if constexpr (std::is_same_v<ValueType, long long>) {
+        return SchemaValueKind::LongLong;
+    } else if constexpr (std::is_same_v<ValueType, unsigned long long>) {
+        return SchemaValueKind::ULongLong;
+    } else if constexpr (std::is_same_v<ValueType, float>) {
+        return SchemaValueKind::Float;
+    } else if constexpr (std::is_same_v<ValueType, double>) {
+        return SchemaValueKind::Double;
+    } else if constexpr (std::is_same_v<ValueType, long double>) {
+        return SchemaValueKind::LongDouble;
+    } else if constexpr (std::is_same_v<ValueType, std::string>) {
+        return SchemaValueKind::String;
+    } else {
+        return SchemaValueKind::Other;
+    }
+}
+
+struct ValueFormat
+{
+    SchemaValueKind kind = SchemaValueKind::Other;
+    char delimiter = '\0';
+    char escape = '\0';
+};
+
+template <class ValueType>
+ValueFormat format_of(Argument<ValueType>*) {
+    return {kind_of<ValueType>()};
+}
+
+template <class ValueType>
+ValueFormat format_of(BoundArgument<ValueType>*) {
+    return {kind_of<ValueType>()};
+}
+
+template <class ValueType>
+ValueFormat format_of(ArgumentList<ValueType>* argument) {
+    return {kind_of<ValueType>(), argument->get_delimiter(), argument->get_escape()};
+}
+
+template <class ValueType>
+ValueFormat format_of(BoundArgumentList<ValueType>* argument) {
+    return {kind_of<ValueType>(), argument->get_delimiter(), argument->get_escape()};
+}
+
+ValueFormat format_of(iArgument* argument) {
+    if (const auto schema_argument = dynamic_cast<const SchemaArgument*>(argument)) {
+        return {schema_argument->get_value_kind(), schema_argument->get_delimiter(), schema_argument->get_escape()};
+    }
+    return {};
+}
+
+class SchemaWriter
+{
+public:
+    std::string write(const iOptions& root) {
+        nodes_.push_back(&root);
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            write_node(*nodes_[i]);
+        }
+
+        Header header;
+        std::memcpy(header.magic, SCHEMA_MAGIC, sizeof(header.magic));
+        header.version = SCHEMA_VERSION;
+        header.nodes_count = static_cast<uint32_t>(node_records_.size());
+        header.flags_count = static_cast<uint32_t>(flag_records_.size());
+        header.arguments_count = static_cast<uint32_t>(argument_records_.size());
+        header.subcommands_count = static_cast<uint32_t>(subcommands_.size());
+        header.short_entries_count = static_cast<uint32_t>(short_entries_.size());
+        header.long_entries_count = static_cast<uint32_t>(long_entries_.size());
+        header.allowed_values_count = static_cast<uint32_t>(allowed_values_.size());
+        header.strings_size = static_cast<uint32_t>(strings_.size());
+
+        const size_t size = sizeof(header) + bytes(node_records_) + bytes(flag_records_) + bytes(argument_records_)
+                            + bytes(subcommands_) + bytes(subcommand_entries_) + bytes(short_entries_)
+                            + bytes(long_entries_) + bytes(allowed_values_) + strings_.size();
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("schema is too big");
+        }
+        header.size = static_cast<uint32_t>(size);
+
+        std::string blob;
+        blob.reserve(size);
+        append(blob, &header, sizeof(header));
+        append(blob, node_records_.data(), bytes(node_records_));
+        append(blob, flag_records_.data(), bytes(flag_records_));
+        append(blob, argument_records_.data(), bytes(argument_records_));
+        append(blob, subcommands_.data(), bytes(subcommands_));
+        append(blob, subcommand_entries_.data(), bytes(subcommand_entries_));
+        append(blob, short_entries_.data(), bytes(short_entries_));
+        append(blob, long_entries_.data(), bytes(long_entries_));
+        append(blob, allowed_values_.data(), bytes(allowed_values_));
+        blob += strings_;
+        return blob;
+    }
+
+private:
+    template <class Record>
+    static size_t bytes(const std::vector<Record>& records) {
+        return records.size() * sizeof(Record);
+    }
+
+    static void append(std::string& blob, const void* data, size_t size) {
+        blob.append(static_cast<const char*>(data), size);
+    }
+
+    StringRef intern(std::string_view str) {
+        const auto it = interned_.find(str);
+        if (it != interned_.end()) {
+            return it->second;
+        }
+
+        const StringRef ref{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(str.size())};
+        strings_ += str;
+        interned_.emplace(str, ref);
+        return ref;
+    }
+
+    std::string_view string(const StringRef& ref) const noexcept {
+        return std::string_view{strings_}.substr(ref.offset, ref.size);
+    }
+
+    void add_names(char short_name, std::string_view long_name, uint32_t value) {
+        if (short_name != '\0') {
+            short_entries_.push_back({static_cast<uint8_t>(short_name), {}, value});
+        }
+
+        if (!long_name.empty()) {
+            long_entries_.push_back({intern(long_name), value});
+        }
+    }
+
+    void sort_names(size_t first_short_entry, size_t first_long_entry) {
+        std::sort(short_entries_.begin() + first_short_entry, short_entries_.end(),
+                  [](const ShortEntry& lhs, const ShortEntry& rhs) { return lhs.short_name < rhs.short_name; });
+        std::sort(long_entries_.begin() + first_long_entry, long_entries_.end(),
+                  [this](const NameEntry& lhs, const NameEntry& rhs) { return string(lhs.name) < string(rhs.name); });
+    }
+
+    void write_node(const iOptions& node) {
+        NodeRecord record;
+        record.name = intern(node.get_name());
+        record.description = intern(node.get_description());
+        record.first_short_entry = static_cast<uint32_t>(short_entries_.size());
+        record.first_long_entry = static_cast<uint32_t>(long_entries_.size());
+
+        record.first_flag = static_cast<uint32_t>(flag_records_.size());
+        record.flags_count = static_cast<uint32_t>(node.flags_count());
+        for (size_t i = 0; i < node.flags_count(); ++i) {
+            const auto flag = node.get_flag(i);
+            FlagRecord flag_record{};
+            flag_record.long_name = intern(flag->get_long_name());
+            flag_record.description = intern(flag->get_description());
+            flag_record.short_name = static_cast<uint8_t>(flag->get_short_name());
+            flag_record.countable = flag->is_countable() ? 1 : 0;
+            flag_records_.push_back(flag_record);
+            add_names(flag->get_short_name(), flag->get_long_name(), static_cast<uint32_t>(2 * i));
+        }
+
+        record.first_argument = static_cast<uint32_t>(argument_records_.size());
+        record.arguments_count = static_cast<uint32_t>(node.arguments_count());
+        for (size_t i = 0; i < node.arguments_count(); ++i) {
+            const auto argument = node.get_argument(i);
+            const auto format = std::visit([](auto* kind) { return format_of(kind); }, argument->typed_ref());
+            ArgumentRecord argument_record{};
+            argument_record.long_name = intern(argument->get_long_name());
+            argument_record.description = intern(argument->get_description());
+            argument_record.type_name = intern(argument->get_type_name());
+            argument_record.default_value = intern(argument->get_default_value());
+            argument_record.first_allowed_value = static_cast<uint32_t>(allowed_values_.size());
+            argument_record.allowed_values_count = static_cast<uint32_t>(argument->allowed_values_count());
+            for (size_t v = 0; v < argument->allowed_values_count(); ++v) {
+                allowed_values_.push_back(intern(argument->get_allowed_value(v)));
+            }
+            argument_record.short_name = static_cast<uint8_t>(argument->get_short_name());
+            argument_record.kind = static_cast<uint8_t>(format.kind);
+            argument_record.attributes = (argument->is_required() ? REQUIRED : 0)
+                                         | (argument->is_many_values() ? MANY_VALUES : 0)
+                                         | (argument->has_default_value() ? HAS_DEFAULT : 0);
+            argument_record.delimiter = static_cast<uint8_t>(format.delimiter);
+            argument_record.escape = static_cast<uint8_t>(format.escape);
+            argument_records_.push_back(argument_record);
+            add_names(argument->get_short_name(), argument->get_long_name(), static_cast<uint32_t>(2 * i + 1));
+        }
+
+        record.short_entries_count = static_cast<uint32_t>(short_entries_.size() - record.first_short_entry);
+        record.long_entries_count = static_cast<uint32_t>(long_entries_.size() - record.first_long_entry);
+        sort_names(record.first_short_entry, record.first_long_entry);
+
+        record.first_subcommand = static_cast<uint32_t>(subcommands_.size());
+        record.subcommands_count = static_cast<uint32_t>(node.subcommands_count());
+        for (size_t i = 0; i < node.subcommands_count(); ++i) {
+            const auto subcommand = node.get_subcommand(i);
+            subcommands_.push_back(static_cast<uint32_t>(nodes_.size()));
+            subcommand_entries_.push_back({intern(subcommand->get_name()), static_cast<uint32_t>(i)});
+            nodes_.push_back(subcommand.get());
+        }
+        std::sort(subcommand_entries_.begin() + record.first_subcommand, subcommand_entries_.end(),
+                  [this](const NameEntry& lhs, const NameEntry& rhs) { return string(lhs.name) < string(rhs.name); });
+
+        node_records_.push_back(record);
+    }
+
+private:
+    std::vector<const iOptions*> nodes_;
+    std::vector<NodeRecord> node_records_;
+    std::vector<FlagRecord> flag_records_;
+    std::vector<ArgumentRecord> argument_records_;
+    std::vector<uint32_t> subcommands_;
+    std::vector<NameEntry> subcommand_entries_;
+    std::vector<ShortEntry> short_entries_;
+    std::vector<NameEntry> long_entries_;
+    std::vector<StringRef> allowed_values_;
+    std::string strings_;
+    std::unordered_map<std::string_view, StringRef> interned_;
+};
+
+class Mapping
+{
+public:
+    Mapping(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "can't open schema '" + path + "'");
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "can't stat schema '" + path + "'");
+        }
+
+        // empty file isn't mapped, it is reported as malformed schema
+        size_ = static_cast<size_t>(st.st_size);
+        int error = 0;
+        if (size_ != 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            error = data_ == MAP_FAILED ? errno : 0;
+        }
+        ::close(fd);
+
+        if (error != 0) {
+            throw std::system_error(error, std::generic_category(), "can't map schema '" + path + "'");
+        }
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping() {
+        if (data_ != MAP_FAILED) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    std::string_view data() const noexcept {
+        return data_ != MAP_FAILED ? std::string_view{static_cast<const char*>(data_), size_} : std::string_view{};
+    }
+
+private:
+    void* data_ = MAP_FAILED;
+    size_t size_ = 0;
+};
+
+// Sections of checked blob. All offsets and indexes in it are known to be in range.
+struct SchemaBlob
+{
+    const NodeRecord* nodes = nullptr;
+    const FlagRecord* flags = nullptr;
+    const ArgumentRecord* arguments = nullptr;
+    const uint32_t* subcommands = nullptr;
+    const NameEntry* subcommand_entries = nullptr;
+    const ShortEntry* short_entries = nullptr;
+    const NameEntry* long_entries = nullptr;
+    const StringRef* allowed_values = nullptr;
+    const char* strings = nullptr;
+
+    std::string_view string(const StringRef& ref) const noexcept {
+        return {strings + ref.offset, ref.size};
+    }
+
+    const ShortEntry* find(const ShortEntry* first, uint32_t count, char short_name) const noexcept {
+        const auto last = first + count;
+        const auto it = std::lower_bound(first, last, static_cast<uint8_t>(short_name),
+                                         [](const ShortEntry& entry, uint8_t name) { return entry.short_name < name; });
+        return it != last && it->short_name == static_cast<uint8_t>(short_name) ? it : nullptr;
+    }
+
+    const NameEntry* find(const NameEntry* first, uint32_t count, std::string_view name) const noexcept {
+        const auto last = first + count;
+        const auto it = _lower_bound(first, last, name);
+        return it != last && string(it->name) == name ? it : nullptr;
+    }
+
+    // Same rules as NameTrie::find_prefix(): exact name wins, empty prefix matches nothing. Names with
+    // common prefix are adjacent in sorted index, so both ends of the range are binary searched.
+    std::pair<size_t, const NameEntry*> find_prefix(const NameEntry* first, uint32_t count,
+                                                    std::string_view prefix) const noexcept {
+        if (prefix.empty()) {
+            return {0, nullptr};
+        }
+
+        const auto last = first + count;
+        const auto begin = _lower_bound(first, last, prefix);
+        if (begin != last && string(begin->name) == prefix) {
+            return {1, begin};
+        }
+
+        const auto end = std::partition_point(begin, last, [this, prefix](const NameEntry& entry) {
+            return string(entry.name).substr(0, prefix.size()) == prefix;
+        });
+        const auto matches = static_cast<size_t>(end - begin);
+        return {matches, matches == 1 ? begin : nullptr};
+    }
+
+    SchemaArgument::Attributes argument_attributes(uint32_t index) const {
+        const auto& record = arguments[index];
+        SchemaArgument::Attributes attributes;
+        attributes.short_name = static_cast<char>(record.short_name);
+        attributes.kind = static_cast<SchemaValueKind>(record.kind);
+        attributes.required = (record.attributes & REQUIRED) != 0;
+        attributes.many_values = (record.attributes & MANY_VALUES) != 0;
+        attributes.has_default = (record.attributes & HAS_DEFAULT) != 0;
+        attributes.long_name = string(record.long_name);
+        attributes.description = string(record.description);
+        attributes.type_name = string(record.type_name);
+        attributes.default_value = string(record.default_value);
+        attributes.delimiter = static_cast<char>(record.delimiter);
+        attributes.escape = static_cast<char>(record.escape);
+        attributes.allowed_values.reserve(record.allowed_values_count);
+        for (uint32_t i = 0; i < record.allowed_values_count; ++i) {
+            attributes.allowed_values.push_back(string(allowed_values[record.first_allowed_value + i]));
+        }
+        return attributes;
+    }
+
+private:
+    const NameEntry* _lower_bound(const NameEntry* first, const NameEntry* last, std::string_view name) const noexcept {
+        return std::lower_bound(first, last, name, [this](const NameEntry& entry, std::string_view value) {
+            return string(entry.name) < value;
+        });
+    }
+};
+
+struct SchemaStorage;
+
+// Flags, arguments and subcommands are created on their first access and live as long as the tree.
+// Lookups may run concurrently, creation is serialized by the storage mutex.
+class SchemaOptions : public iOptions
+{
+public:
+    SchemaOptions(SchemaStorage* storage, uint32_t index) noexcept;
+
+    std::string_view get_name() const noexcept override;
+    std::string_view get_description() const noexcept override;
+    size_t flags_count() const noexcept override;
+    size_t arguments_count() const noexcept override;
+    size_t subcommands_count() const noexcept override;
+    FlagPtr get_flag(size_t idx) const override;
+    ArgumentPtr get_argument(size_t idx) const override;
+    SubcommandPtr get_subcommand(size_t idx) const override;
+    FlagPtr find_flag(char short_name) const override;
+    FlagPtr find_flag(std::string_view long_name) const override;
+    FlagCountPtr find_flag_count(char short_name) const noexcept override;
+    FlagCountPtr find_flag_count(std::string_view long_name) const noexcept override;
+    ArgumentPtr find_argument(char short_name) const override;
+    ArgumentPtr find_argument(std::string_view long_name) const override;
+    std::tuple<size_t, FlagPtr, ArgumentPtr> find_long_name_prefix(std::string_view prefix) const override;
+    SubcommandPtr find_subcommand(std::string_view name) const override;
+    std::pair<size_t, SubcommandPtr> find_subcommand_prefix(std::string_view prefix) const override;
+    size_t find_missing_required(size_t from) const override;
+    void add(FlagPtr&& flag) override;
+    void add(ArgumentPtr&& arg) override;
+    void add(SubcommandPtr&& sub) override;
+    void reset_to_default() noexcept override;
+
+private:
+    // `value` is index of name entry, flags are even and arguments are odd
+    FlagPtr _flag(uint32_t value) const;
+    ArgumentPtr _argument(uint32_t value) const;
+    void _reset() noexcept;
+
+private:
+    SchemaStorage* storage_;
+    const SchemaBlob& blob_;
+    const NodeRecord& record_;
+    // keyed by index within the node
+    mutable std::unordered_map<uint32_t, SchemaFlag> flags_;
+    mutable std::unordered_map<uint32_t, SchemaArgument> arguments_;
+};
+
+struct SchemaStorage : std::enable_shared_from_this<SchemaStorage>
+{
+    std::unique_ptr<Mapping> mapping;
+    SchemaBlob blob;
+    std::mutex mutex;
+    // keyed by index of node record, guarded by the mutex
+    std::unordered_map<uint32_t, SchemaOptions> nodes;
+
+    // caller holds the mutex
+    SchemaOptions& node(uint32_t index) {
+        return nodes.try_emplace(index, this, index).first->second;
+    }
+
+    template <class Node>
+    std::shared_ptr<Node> share(Node& node) {
+        return {shared_from_this(), &node};
+    }
+};
+
+SchemaOptions::SchemaOptions(SchemaStorage* storage, uint32_t index) noexcept
+    : storage_{storage}
+    , blob_{storage->blob}
+    , record_{storage->blob.nodes[index]} {
+}
+
+std::string_view SchemaOptions::get_name() const noexcept {
+    return blob_.string(record_.name);
+}
+
+std::string_view SchemaOptions::get_description() const noexcept {
+    return blob_.string(record_.description);
+}
+
+size_t SchemaOptions::flags_count() const noexcept {
+    return record_.flags_count;
+}
+
+size_t SchemaOptions::arguments_count() const noexcept {
+    return record_.arguments_count;
+}
+
+size_t SchemaOptions::subcommands_count() const noexcept {
+    return record_.subcommands_count;
+}
+
+iOptions::FlagPtr SchemaOptions::get_flag(size_t idx) const {
+    return _flag(static_cast<uint32_t>(2 * idx));
+}
+
+iOptions::ArgumentPtr SchemaOptions::get_argument(size_t idx) const {
+    return _argument(static_cast<uint32_t>(2 * idx + 1));
+}
+
+iOptions::SubcommandPtr SchemaOptions::get_subcommand(size_t idx) const {
+    std::lock_guard<std::mutex> lock{storage_->mutex};
+    return storage_->share(storage_->node(blob_.subcommands[record_.first_subcommand + idx]));
+}
+
+iOptions::FlagPtr SchemaOptions::find_flag(char short_name) const {
+    const auto entry = blob_.find(blob_.short_entries + record_.first_short_entry, record_.short_entries_count,
+                                  short_name);
+    return entry != nullptr ? _flag(entry->value) : nullptr;
+}
+
+iOptions::FlagPtr SchemaOptions::find_flag(std::string_view long_name) const {
+    const auto entry = blob_.find(blob_.long_entries + record_.first_long_entry, record_.long_entries_count,
+                                  long_name);
+    return entry != nullptr ? _flag(entry->value) : nullptr;
+}
+
+iOptions::FlagCountPtr SchemaOptions::find_flag_count(char) const noexcept {
+    return nullptr;
+}
+
+iOptions::FlagCountPtr SchemaOptions::find_flag_count(std::string_view) const noexcept {
+    return nullptr;
+}
+
+iOptions::ArgumentPtr SchemaOptions::find_argument(char short_name) const {
+    const auto entry = blob_.find(blob_.short_entries + record_.first_short_entry, record_.short_entries_count,
+                                  short_name);
+    return entry != nullptr ? _argument(entry->value) : nullptr;
+}
+
+iOptions::ArgumentPtr SchemaOptions::find_argument(std::string_view long_name) const {
+    const auto entry = blob_.find(blob_.long_entries + record_.first_long_entry, record_.long_entries_count,
+                                  long_name);
+    return entry != nullptr ? _argument(entry->value) : nullptr;
+}
+
+std::tuple<size_t, iOptions::FlagPtr, iOptions::ArgumentPtr> SchemaOptions::find_long_name_prefix(
+    std::string_view prefix) const {
+    const auto [count, entry] = blob_.find_prefix(blob_.long_entries + record_.first_long_entry,
+                                                  record_.long_entries_count, prefix);
+    if (entry == nullptr) {
+        return {count, nullptr, nullptr};
+    }
+    return {1, _flag(entry->value), _argument(entry->value)};
+}
+
+iOptions::SubcommandPtr SchemaOptions::find_subcommand(std::string_view name) const {
+    const auto entry = blob_.find(blob_.subcommand_entries + record_.first_subcommand, record_.subcommands_count,
+                                  name);
+    return entry != nullptr ? get_subcommand(entry->value) : nullptr;
+}
+
+std::pair<size_t, iOptions::SubcommandPtr> SchemaOptions::find_subcommand_prefix(std::string_view prefix) const {
+    const auto [count, entry] = blob_.find_prefix(blob_.subcommand_entries + record_.first_subcommand,
+                                                  record_.subcommands_count, prefix);
+    return {count, entry != nullptr ? get_subcommand(entry->value) : nullptr};
+}
+
+// arguments which weren't looked up have no values, so they aren't created just to be checked
+size_t SchemaOptions::find_missing_required(size_t from) const {
+    std::lock_guard<std::mutex> lock{storage_->mutex};
+    for (uint32_t idx = static_cast<uint32_t>(from); idx < record_.arguments_count; ++idx) {
+        const auto attributes = blob_.arguments[record_.first_argument + idx].attributes;
+        if ((attributes & REQUIRED) == 0 || (attributes & HAS_DEFAULT) != 0) {
+            continue;
+        }
+
+        const auto it = arguments_.find(idx);
+        if (it == arguments_.end() || !it->second.has_value()) {
+            return idx;
+        }
+    }
+    return record_.arguments_count;
+}
+
+void SchemaOptions::add(FlagPtr&&) {
+    throw std::logic_error("schema options are read only");
+}
+
+void SchemaOptions::add(ArgumentPtr&&) {
+    throw std::logic_error("schema options are read only");
+}
+
+void SchemaOptions::add(SubcommandPtr&&) {
+    throw std::logic_error("schema options are read only");
+}
+
+// only created nodes can hold values
+void SchemaOptions::reset_to_default() noexcept {
+    std::lock_guard<std::mutex> lock{storage_->mutex};
+    _reset();
+}
+
+iOptions::FlagPtr SchemaOptions::_flag(uint32_t value) const {
+    if (value % 2 != 0) {
+        return nullptr;
+    }
+
+    const auto idx = value / 2;
+    const auto& record = blob_.flags[record_.first_flag + idx];
+    std::lock_guard<std::mutex> lock{storage_->mutex};
+    auto& flag = flags_
+                     .try_emplace(idx, static_cast<char>(record.short_name), record.countable != 0,
+                                  blob_.string(record.long_name), blob_.string(record.description))
+                     .first->second;
+    return storage_->share(flag);
+}
+
+iOptions::ArgumentPtr SchemaOptions::_argument(uint32_t value) const {
+    if (value % 2 == 0) {
+        return nullptr;
+    }
+
+    const auto idx = value / 2;
+    std::lock_guard<std::mutex> lock{storage_->mutex};
+    auto it = arguments_.find(idx);
+    if (it == arguments_.end()) {
+        it = arguments_.emplace(idx, blob_.argument_attributes(record_.first_argument + idx)).first;
+    }
+    return storage_->share(it->second);
+}
+
+void SchemaOptions::_reset() noexcept {
+    for (auto& flag : flags_) {
+        flag.second.reset_to_default();
+    }
+
+    for (auto& argument : arguments_) {
+        argument.second.reset_to_default();
+    }
+
+    for (uint32_t i = 0; i < record_.subcommands_count; ++i) {
+        const auto it = storage_->nodes.find(blob_.subcommands[record_.first_subcommand + i]);
+        if (it != storage_->nodes.end()) {
+            it->second._reset();
+        }
+    }
+}
+
+class SchemaReader
+{
+public:
+    SchemaReader(std::string_view blob)
+        : blob_{blob} {
+    }
+
+    // Checks every record and index entry once, without allocating, so lookups needn't check anything.
+    SchemaBlob read() {
+        if (blob_.size() < sizeof(Header)) {
+            malformed("truncated header");
+        }
+
+        if (reinterpret_cast<uintptr_t>(blob_.data()) % alignof(uint32_t) != 0) {
+            throw std::invalid_argument("schema blob must be 4-byte aligned");
+        }
+
+        const auto& header = *reinterpret_cast<const Header*>(blob_.data());
+        if (std::memcmp(header.magic, SCHEMA_MAGIC, sizeof(header.magic)) != 0) {
+            malformed("wrong magic");
+        }
+
+        if (header.version != SCHEMA_VERSION) {
+            malformed("unsupported version");
+        }
+
+        if (header.size != blob_.size() || header.nodes_count == 0) {
+            malformed("wrong size");
+        }
+
+        uint64_t offset = sizeof(Header);
+        SchemaBlob blob;
+        blob.nodes = section<NodeRecord>(offset, header.nodes_count);
+        blob.flags = section<FlagRecord>(offset, header.flags_count);
+        blob.arguments = section<ArgumentRecord>(offset, header.arguments_count);
+        blob.subcommands = section<uint32_t>(offset, header.subcommands_count);
+        blob.subcommand_entries = section<NameEntry>(offset, header.subcommands_count);
+        blob.short_entries = section<ShortEntry>(offset, header.short_entries_count);
+        blob.long_entries = section<NameEntry>(offset, header.long_entries_count);
+        blob.allowed_values = section<StringRef>(offset, header.allowed_values_count);
+        blob.strings = section<char>(offset, header.strings_size);
+        strings_size_ = header.strings_size;
+        if (offset != blob_.size()) {
+            malformed("wrong size");
+        }
+
+        for (uint32_t i = 0; i < header.flags_count; ++i) {
+            check(blob.flags[i].long_name);
+            check(blob.flags[i].description);
+        }
+
+        for (uint32_t i = 0; i < header.arguments_count; ++i) {
+            const auto& record = blob.arguments[i];
+            if (record.kind > static_cast<uint8_t>(SchemaValueKind::String)) {
+                malformed("unknown value kind");
+            }
+            check(record.long_name);
+            check(record.description);
+            check(record.type_name);
+            check(record.default_value);
+            range(record.first_allowed_value, record.allowed_values_count, header.allowed_values_count);
+        }
+
+        for (uint32_t i = 0; i < header.allowed_values_count; ++i) {
+            check(blob.allowed_values[i]);
+        }
+
+        for (uint32_t i = 0; i < header.nodes_count; ++i) {
+            const auto& record = blob.nodes[i];
+            check(record.name);
+            check(record.description);
+            range(record.first_flag, record.flags_count, header.flags_count);
+            range(record.first_argument, record.arguments_count, header.arguments_count);
+            range(record.first_subcommand, record.subcommands_count, header.subcommands_count);
+            range(record.first_short_entry, record.short_entries_count, header.short_entries_count);
+            range(record.first_long_entry, record.long_entries_count, header.long_entries_count);
+
+            for (uint32_t s = 0; s < record.subcommands_count; ++s) {
+                // children always follow their parent, so the tree can't have cycles
+                const auto child = blob.subcommands[record.first_subcommand + s];
+                if (child <= i || child >= header.nodes_count) {
+                    malformed("wrong subcommand index");
+                }
+
+                const auto& entry = blob.subcommand_entries[record.first_subcommand + s];
+                check(entry.name);
+                if (entry.value >= record.subcommands_count) {
+                    malformed("wrong subcommand index");
+                }
+            }
+
+            for (uint32_t e = 0; e < record.short_entries_count; ++e) {
+                check(blob.short_entries[record.first_short_entry + e].value, record);
+            }
+
+            for (uint32_t e = 0; e < record.long_entries_count; ++e) {
+                const auto& entry = blob.long_entries[record.first_long_entry + e];
+                check(entry.name);
+                check(entry.value, record);
+            }
+        }
+
+        return blob;
+    }
+
+private:
+    [[noreturn]] static void malformed(const char* reason) {
+        throw std::invalid_argument(std::string("malformed schema: ") + reason);
+    }
+
+    template <class Record>
+    const Record* section(uint64_t& offset, uint32_t count) {
+        const uint64_t size = static_cast<uint64_t>(count) * sizeof(Record);
+        if (offset + size > blob_.size()) {
+            malformed("truncated section");
+        }
+
+        const auto records = reinterpret_cast<const Record*>(blob_.data() + offset);
+        offset += size;
+        return records;
+    }
+
+    static void range(uint32_t first, uint32_t count, uint32_t total) {
+        if (static_cast<uint64_t>(first) + count > total) {
+            malformed("wrong range");
+        }
+    }
+
+    void check(const StringRef& ref) const {
+        if (static_cast<uint64_t>(ref.offset) + ref.size > strings_size_) {
+            malformed("wrong string reference");
+        }
+    }
+
+    static void check(uint32_t value, const NodeRecord& record) {
+        if (value / 2 >= (value % 2 == 0 ? record.flags_count : record.arguments_count)) {
+            malformed("wrong name index");
+        }
+    }
+
+private:
+    std::string_view blob_;
+    uint32_t strings_size_ = 0;
+};
+
+std::shared_ptr<SchemaStorage> make_storage(std::string_view data, std::unique_ptr<Mapping> mapping = nullptr) {
+    auto storage = std::make_shared<SchemaStorage>();
+    storage->blob = SchemaReader{data}.read();
+    storage->mapping = std::move(mapping);
+    return storage;
+}
+
+OptionsPtr root_of(const std::shared_ptr<SchemaStorage>& storage) {
+    std::lock_guard<std::mutex> lock{storage->mutex};
+    return storage->share(storage->node(0));
+}
+
+template <class ValueType>
+std::pair<bool, std::string> validate(const std::string_view& value) {
+    std::optional<ValueType> parsed;
+    return parse_value(value, &parsed);
+}
+
+}  // namespace
+
+std::string serialize_schema(const iOptions& options) {
+    return SchemaWriter{}.write(options);
+}
+
+OptionsPtr load_schema(const std::string& path) {
+    auto mapping = std::make_unique<Mapping>(path);
+    const auto data = mapping->data();
+    return root_of(make_storage(data, std::move(mapping)));
+}
+
+OptionsPtr load_schema(std::string_view blob) {
+    return root_of(make_storage(blob));
+}
+
+SchemaFlag::SchemaFlag(char short_name, bool countable, std::string_view long_name,
+                       std::string_view description) noexcept
+    : short_name_{short_name}
+    , countable_{countable}
+    , long_name_{long_name}
+    , description_{description} {
+}
+
+char SchemaFlag::get_short_name() const noexcept {
+    return short_name_;
+}
+
+std::string_view SchemaFlag::get_long_name() const noexcept {
+    return long_name_;
+}
+
+std::string_view SchemaFlag::get_description() const noexcept {
+    return description_;
+}
+
+bool SchemaFlag::is_countable() const noexcept {
+    return countable_;
+}
+
+void SchemaFlag::set_found() noexcept {
+    count_ += 1;
+}
+
+void SchemaFlag::set_count(size_t count) noexcept {
+    count_ = count;
+}
+
+bool SchemaFlag::is_set() const noexcept {
+    return count_ != 0;
+}
+
+void SchemaFlag::reset_to_default() noexcept {
+    count_ = 0;
+}
+
+size_t SchemaFlag::get_count() const noexcept {
+    return count_;
+}
+
+SchemaArgument::SchemaArgument(Attributes attributes) noexcept
+    : attributes_{std::move(attributes)} {
+}
+
+char SchemaArgument::get_short_name() const noexcept {
+    return attributes_.short_name;
+}
+
+std::string_view SchemaArgument::get_long_name() const noexcept {
+    return attributes_.long_name;
+}
+
+std::string_view SchemaArgument::get_description() const noexcept {
+    return attributes_.description;
+}
+
+std::string_view SchemaArgument::get_type_name() const {
+    return attributes_.type_name;
+}
+
+std::string_view SchemaArgument::get_default_value() const {
+    return attributes_.default_value;
+}
+
+bool SchemaArgument::has_value() const noexcept {
+    return !values_.empty() || has_default_value();
+}
+
+bool SchemaArgument::has_default_value() const noexcept {
+    return attributes_.has_default;
+}
+
+bool SchemaArgument::is_required() const noexcept {
+    return attributes_.required;
+}
+
+bool SchemaArgument::is_many_values() const noexcept {
+    return attributes_.many_values;
+}
+
+void SchemaArgument::reset_to_default() noexcept {
+    values_.clear();
+    _drop_cache();
+}
+
+bool SchemaArgument::save_state(details::StateWriter& out) const {
+    if (values_.empty()) {
+        return false;
+    }
+    out.values(values_);
+    return true;
+}
+
+// values were validated when they were set, so they are taken as is
+void SchemaArgument::restore_state(details::StateReader& in) {
+    _drop_cache();
+    in.values(&values_);
+}
+
+size_t SchemaArgument::allowed_values_count() const noexcept {
+    return attributes_.allowed_values.size();
+}
+
+std::string_view SchemaArgument::get_allowed_value(size_t idx) const noexcept {
+    return attributes_.allowed_values[idx];
+}
+
+std::pair<bool, std::string> SchemaArgument::set_string_value(const std::string_view& value) noexcept {
+    if (attributes_.delimiter == '\0') {
+        auto result = _validate(value);
+        if (!result.first) {
+            return result;
+        }
+
+        if (!attributes_.many_values) {
+            values_.clear();
+        }
+        values_.emplace_back(value);
+        _drop_cache();
+        return result;
+    }
+
+    // either all elements of occurrence are taken or none of them
+    const size_t initial_size = values_.size();
+    std::pair<bool, std::string> result{true, std::string{}};
+    std::string buffer;
+    details::for_each_slice(value, attributes_.delimiter, attributes_.escape, buffer, [&](std::string_view slice) {
+        result = _validate(slice);
+        if (!result.first) {
+            return false;
+        }
+        values_.emplace_back(slice);
+        return true;
+    });
+
+    if (!result.first) {
+        values_.erase(values_.begin() + initial_size, values_.end());
+        return result;
+    }
+    _drop_cache();
+    return result;
+}
+
+SchemaValueKind SchemaArgument::get_value_kind() const noexcept {
+    return attributes_.kind;
+}
+
+char SchemaArgument::get_delimiter() const noexcept {
+    return attributes_.delimiter;
+}
+
+char SchemaArgument::get_escape() const noexcept {
+    return attributes_.escape;
+}
+
+std::pair<bool, std::string> SchemaArgument::_validate(std::string_view value) const {
+    const auto& allowed = attributes_.allowed_values;
+    if (!allowed.empty() && std::find(allowed.begin(), allowed.end(), value) == allowed.end()) {
+        std::string message = "unexpected value '" + std::string(value) + "', expected one of: ";
+        for (size_t i = 0; i < allowed.size(); ++i) {
+            message += i == 0 ? "" : ", ";
+            message += allowed[i];
+        }
+        return {false, std::move(message)};
+    }
+
+    switch (attributes_.kind) {
+        case SchemaValueKind::Short:
+            return validate<short>(value);
+        case SchemaValueKind::UShort:
+            return validate<unsigned short>(value);
+        case SchemaValueKind::Int:
+            return validate<int>(value);
+        case SchemaValueKind::UInt:
+            return validate<unsigned int>(value);
+        case SchemaValueKind::Long:
+            return validate<long>(value);
+        case SchemaValueKind::ULong:
+            return validate<unsigned long>(value);
+        case SchemaValueKind::LongLong:
+            return validate<long long>(value);
+        case SchemaValueKind::ULongLong:
+            return validate<unsigned long long>(value);
+        case SchemaValueKind::Float:
+            return validate<float>(value);
+        case SchemaValueKind::Double:
+            return validate<double>(value);
+        case SchemaValueKind::LongDouble:
+            return validate<long double>(value);
+        case SchemaValueKind::String:
+        case SchemaValueKind::Other:
+            break;
+    }
+    return {true, std::string{}};
+}
+
+void SchemaArgument::_drop_cache() noexcept {
+    value_cache_.reset();
+    values_cache_.reset();
+}
+
+}  // namespace xdx::cliopts
@@ -0,0 +1,92 @@
+#include <xdx/cliopts/details/split.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XDX_CLIOPTS_SSE2 1
+#endif
+
+namespace xdx::cliopts::details
+{
+
+namespace
+{
+
+#if defined(XDX_CLIOPTS_SSE2)
+
+constexpr size_t BLOCK_SIZE = 16;
+
+unsigned count_bits(unsigned mask) noexcept {
+    mask = mask - ((mask >> 1) & 0x5555u);
+    mask = (mask & 0x3333u) + ((mask >> 2) & 0x3333u);
+    mask = (mask + (mask >> 4)) & 0x0f0fu;
+    return (mask + (mask >> 8)) & 0x1fu;
+}
+
+unsigned lowest_bit(unsigned mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned idx = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        idx += 1;
+    }
+    return idx;
+#endif
+}
+
+__m128i load(const char* data) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+#endif
+
+}  // namespace
+
+size_t count_char(std::string_view text, char ch) noexcept {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t count = 0;
+    size_t idx = 0;
+
+#if defined(XDX_CLIOPTS_SSE2)
+    const __m128i needle = _mm_set1_epi8(ch);
+    for (; idx + BLOCK_SIZE <= size; idx += BLOCK_SIZE) {
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(load(data + idx), needle)));
+        count += count_bits(mask);
+    }
+#endif
+
+    for (; idx < size; ++idx) {
+        count += data[idx] == ch ? 1 : 0;
+    }
+    return count;
+}
+
+size_t find_any(std::string_view text, size_t from, char first, char second) noexcept {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t idx = from;
+
+#if defined(XDX_CLIOPTS_SSE2)
+    const __m128i first_needle = _mm_set1_epi8(first);
+    const __m128i second_needle = _mm_set1_epi8(second);
+    for (; idx + BLOCK_SIZE <= size; idx += BLOCK_SIZE) {
+        const __m128i block = load(data + idx);
+        const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(block, first_needle), _mm_cmpeq_epi8(block, second_needle));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(matches));
+        if (mask != 0) {
+            return idx + lowest_bit(mask);
+        }
+    }
+#endif
+
+    for (; idx < size; ++idx) {
+        if (data[idx] == first || data[idx] == second) {
+            return idx;
+        }
+    }
+    return text.npos;
+}
+
+}  // namespace xdx::cliopts::details
@@ -0,0 +1,149 @@
+#include <xdx/cliopts/argument.hpp>
+#include <xdx/cliopts/details/state_codec.hpp>
+#include <xdx/cliopts/flag.hpp>
+#include <xdx/cliopts/state.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace xdx::cliopts
+{
+
+namespace
+{
+
+constexpr char STATE_MAGIC[4] = {'X', 'D', 'X', 'P'};
+constexpr uint32_t STATE_VERSION = 1;
+
+// blob layout: magic, version, path size, path names, then for the root and every command of the path:
+// flags count, (flag index, count)..., arguments count, (argument index, values)...
+void write_node(details::StateWriter& writer, std::string& blob, const iOptions& node) {
+    const auto flags_count_at = blob.size();
+    size_t flags_set = 0;
+    writer.count(0);
+    for (size_t idx = 0; idx < node.flags_count(); ++idx) {
+        const auto count = node.get_flag(idx)->get_count();
+        if (count != 0) {
+            writer.count(idx);
+            writer.count(count);
+            flags_set += 1;
+        }
+    }
+    const auto flags_set_count = static_cast<uint32_t>(flags_set);
+    std::memcpy(&blob[flags_count_at], &flags_set_count, sizeof(flags_set_count));
+
+    const auto arguments_count_at = blob.size();
+    size_t arguments_set = 0;
+    writer.count(0);
+    for (size_t idx = 0; idx < node.arguments_count(); ++idx) {
+        const auto record_at = blob.size();
+        writer.count(idx);
+        if (node.get_argument(idx)->save_state(writer)) {
+            arguments_set += 1;
+        } else {
+            blob.resize(record_at);
+        }
+    }
+    const auto arguments_set_count = static_cast<uint32_t>(arguments_set);
+    std::memcpy(&blob[arguments_count_at], &arguments_set_count, sizeof(arguments_set_count));
+}
+
+[[noreturn]] void malformed(const char* reason) {
+    throw std::invalid_argument(std::string("malformed state: ") + reason);
+}
+
+size_t read_index(details::StateReader& reader, size_t total) {
+    const auto idx = reader.count();
+    if (idx >= total) {
+        malformed("wrong index");
+    }
+    return idx;
+}
+
+void read_node(details::StateReader& reader, iOptions& node) {
+    const auto flags_set = reader.count();
+    for (size_t i = 0; i < flags_set; ++i) {
+        const auto flag = node.get_flag(read_index(reader, node.flags_count()));
+        const auto count = reader.count();
+        // non countable flags are saved with count 1
+        flag->set_count(flag->is_countable() ? count : 1);
+    }
+
+    const auto arguments_set = reader.count();
+    for (size_t i = 0; i < arguments_set; ++i) {
+        node.get_argument(read_index(reader, node.arguments_count()))->restore_state(reader);
+    }
+}
+
+}  // namespace
+
+std::string serialize_state(const iOptions& options, const Parser::SubcommandsPath& path) {
+    std::string blob(STATE_MAGIC, sizeof(STATE_MAGIC));
+    details::StateWriter writer(blob);
+    writer.count(STATE_VERSION);
+
+    writer.count(path.size());
+    for (const auto& name : path) {
+        writer.string(name);
+    }
+
+    write_node(writer, blob, options);
+    const iOptions* node = &options;
+    Options::SubcommandPtr command;
+    for (const auto& name : path) {
+        command = node->find_subcommand(name);
+        if (!command) {
+            throw std::invalid_argument("unknown subcommand '" + std::string(name) + "' in path");
+        }
+        write_node(writer, blob, *command);
+        node = command.get();
+    }
+    return blob;
+}
+
+Parser::SubcommandsPath restore_state(std::string_view blob, iOptions& options) {
+    if (blob.size() < sizeof(STATE_MAGIC) || std::memcmp(blob.data(), STATE_MAGIC, sizeof(STATE_MAGIC)) != 0) {
+        malformed("wrong magic");
+    }
+
+    details::StateReader reader(blob.substr(sizeof(STATE_MAGIC)));
+    if (reader.count() != STATE_VERSION) {
+        malformed("unsupported version");
+    }
+
+    options.reset_to_default();
+
+    // names are resolved before values are read, so the path can refer to names owned by options
+    Parser::SubcommandsPath path;
+    const auto path_size = reader.count();
+    std::vector<Options::SubcommandPtr> nodes;
+    const iOptions* node = &options;
+    for (size_t i = 0; i < path_size; ++i) {
+        auto command = node->find_subcommand(reader.string());
+        if (!command) {
+            malformed("unknown subcommand");
+        }
+        path.push_back(command->get_name());
+        node = command.get();
+        nodes.push_back(std::move(command));
+    }
+
+    try {
+        read_node(reader, options);
+        for (const auto& command : nodes) {
+            read_node(reader, *command);
+        }
+
+        if (!reader.at_end()) {
+            malformed("trailing data");
+        }
+    } catch (...) {
+        // values read before the error must not look parsed
+        options.reset_to_default();
+        throw;
+    }
+    return path;
+}
+
+}  // namespace xdx::cliopts
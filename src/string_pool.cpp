@@ -0,0 +1,112 @@
+#include <xdx/cliopts/details/string_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace xdx::cliopts::details
+{
+
+std::string_view StringPool::intern(std::string_view str) {
+    if (str.empty()) {
+        return {};
+    }
+
+    // load factor is kept at most 1/2, so probing sequences stay short
+    if ((size_ + 1) * 2 > slots_.size()) {
+        _grow();
+    }
+
+    auto& slot = _slot(str);
+    if (!slot.empty()) {
+        return slot;
+    }
+
+    char* data = allocate(str.size());
+    std::memcpy(data, str.data(), str.size());
+    used_ += str.size();
+
+    slot = std::string_view{data, str.size()};
+    size_ += 1;
+    return slot;
+}
+
+size_t StringPool::size() const noexcept {
+    return size_;
+}
+
+size_t StringPool::bytes_used() const noexcept {
+    return used_;
+}
+
+size_t StringPool::chunks_count() const noexcept {
+    return chunks_.size();
+}
+
+char* StringPool::allocate(size_t size) {
+    if (size > left_) {
+        // oversized strings get own chunk, so current one keeps its free tail
+        if (size > CHUNK_SIZE / 4) {
+            chunks_.emplace_back(new char[size]);
+            return chunks_.back().get();
+        }
+
+        chunks_.emplace_back(new char[CHUNK_SIZE]);
+        cursor_ = chunks_.back().get();
+        left_ = CHUNK_SIZE;
+    }
+
+    char* data = cursor_;
+    cursor_ += size;
+    left_ -= size;
+    return data;
+}
+
+std::string_view& StringPool::_slot(std::string_view str) noexcept {
+    const size_t mask = slots_.size() - 1;
+    for (size_t idx = std::hash<std::string_view>{}(str) & mask;; idx = (idx + 1) & mask) {
+        if (slots_[idx].empty() || slots_[idx] == str) {
+            return slots_[idx];
+        }
+    }
+}
+
+void StringPool::_grow() {
+    std::vector<std::string_view> old = std::exchange(slots_, {});
+    slots_.resize(std::max<size_t>(old.size() * 2, 16));
+    for (const auto str : old) {
+        if (!str.empty()) {
+            _slot(str) = str;
+        }
+    }
+}
+
+std::unique_ptr<char[]> own_strings(std::initializer_list<std::string_view*> views) {
+    size_t total = 0;
+    for (const auto* view : views) {
+        total += view->size();
+    }
+    if (total == 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<char[]> buffer(new char[total]);
+    size_t offset = 0;
+    for (auto* view : views) {
+        if (!view->empty()) {
+            std::memcpy(buffer.get() + offset, view->data(), view->size());
+        }
+        *view = std::string_view{buffer.get() + offset, view->size()};
+        offset += view->size();
+    }
+    return buffer;
+}
+
+void intern_strings(StringPool& pool, std::initializer_list<std::string_view*> views) {
+    for (auto* view : views) {
+        *view = pool.intern(*view);
+    }
+}
+
+}  // namespace xdx::cliopts::details
@@ -8,6 +8,16 @@ constexpr char val_split = '=';
 
 using Token = Tokenizer::Token;
 
+namespace
+{
+
+// entries of range views aren't NUL terminated, so end reads as terminator of C string would
+char char_at(std::string_view entry, size_t idx) {
+    return idx < entry.size() ? entry[idx] : '\0';
+}
+
+}  // namespace
+
 std::pair<bool, Token> Tokenizer::next() {
     if (char_idx_ < 0) {
         entry_idx_ += 1;
@@ -20,16 +30,16 @@ std::pair<bool, Token> Tokenizer::next() {
     }
 
     if (current_token_ == TokenType::Unknown) {
-        if (current_entry_[char_idx_] != arg_prefix) {
+        if (char_at(current_entry_, char_idx_) != arg_prefix) {
             auto tail = current_entry_.substr(char_idx_);
             char_idx_ = -1;
             return {true, {TokenType::None, tail}};
         }
 
         char_idx_ += 1;
-        if (current_entry_[char_idx_] != arg_prefix) {
+        if (char_at(current_entry_, char_idx_) != arg_prefix) {
             current_token_ = TokenType::Short;
-            return {true, {TokenType::Short, current_entry_[char_idx_]}};
+            return {true, {TokenType::Short, char_at(current_entry_, char_idx_)}};
         }
 
         char_idx_ += 1;
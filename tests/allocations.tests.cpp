@@ -0,0 +1,335 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/cliopts.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+std::atomic<bool> counting{false};
+std::atomic<size_t> allocations{0};
+
+void count_allocation() noexcept {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <class Callable>
+size_t count_allocations(Callable&& callable) {
+    allocations = 0;
+    counting = true;
+    callable();
+    counting = false;
+    return allocations;
+}
+
+// the first parse is measured, as it's the only one a program does
+template <size_t N>
+size_t count_parse_allocations(const OptionsPtr& options, const char* (&argv)[N], Parser::ProcessResult& result) {
+    return count_allocations([&] { result = parse_argv(options, static_cast<int>(N), argv); });
+}
+
+}  // namespace
+
+#if defined(__GLIBC__)
+
+// glibc exports the real allocator under these names, so the whole malloc family
+// can be interposed without replacing the allocator itself.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size) {
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+namespace
+{
+
+void* raw_allocate(size_t size) noexcept {
+    return __libc_malloc(size);
+}
+
+void* raw_allocate(size_t size, size_t alignment) noexcept {
+    return __libc_memalign(alignment, size);
+}
+
+void raw_free(void* ptr) noexcept {
+    __libc_free(ptr);
+}
+
+}  // namespace
+
+#else
+
+namespace
+{
+
+void* raw_allocate(size_t size) noexcept {
+    return std::malloc(size);
+}
+
+void* raw_allocate(size_t size, size_t alignment) noexcept {
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void raw_free(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+}  // namespace
+
+#endif
+
+void* operator new(size_t size) {
+    count_allocation();
+    if (void* ptr = raw_allocate(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    count_allocation();
+    return raw_allocate(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    count_allocation();
+    if (void* ptr = raw_allocate(size != 0 ? size : 1, static_cast<size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    raw_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    raw_free(ptr);
+}
+
+TEST(xdx_cliopts_allocations_tests, harness_counts_allocations) {
+    const auto count = count_allocations([] {
+        auto value = std::make_unique<int>(10);
+        auto buffer = static_cast<char*>(std::malloc(16));
+        std::free(buffer);
+    });
+    ASSERT_EQ(2, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, flags_only) {
+    auto builder = Builder("test", "test options")
+                       .flag('s', "simple", "simple flag")
+                       .flag_count('c', "countable", "countable flag");
+    const char* argv[] = {"test", "-sc", "--simple", "-c", "--countable"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(3, builder.get_options()->find_flag_count('c')->get_count());
+    ASSERT_EQ(0, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, numeric_arguments) {
+    auto builder = Builder("test", "test options")
+                       .argument<int>('i', "input"sv, "required int"sv)
+                       .argument<double>('r', "ratio"sv, "double with default"sv, 1.5)
+                       .argument<unsigned long>("size"sv, "required unsigned long"sv);
+    const char* argv[] = {"test", "-i", "20", "--ratio=0.25", "--size", "4096", "-i", "30"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(30, builder.get_options()->find_typed_argument<int>("input")->get_value());
+    ASSERT_EQ(0.25, builder.get_options()->find_typed_argument<double>("ratio")->get_value());
+    ASSERT_EQ(4096, builder.get_options()->find_typed_argument<unsigned long>("size")->get_value());
+    ASSERT_EQ(0, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, argument_list_values) {
+    auto builder = Builder("test", "test options").argument_list<int>('l', "list"sv, "list of ints"sv);
+    const char* argv[] = {"test", "-l", "1", "-l", "2", "--list=3"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ((std::vector<int>{1, 2, 3}), builder.get_options()->find_typed_argument_list<int>("list")->get_values());
+    // values storage grows as 1, 2, 4
+    ASSERT_EQ(3, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, delimited_list_values) {
+    auto builder = Builder("test", "test options").argument_list<int>('l', "list"sv, "list of ints"sv);
+    builder.get_options()->find_typed_argument_list<int>('l')->set_delimiter(',');
+    const char* argv[] = {"test", "--list=1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(20, builder.get_options()->find_typed_argument_list<int>("list")->get_values().size());
+    // storage is reserved from delimiters count once
+    ASSERT_EQ(1, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, constraints) {
+    auto builder = Builder("test", "test options")
+                       .flag('j', "json"sv, "json output"sv)
+                       .flag('y', "yaml"sv, "yaml output"sv)
+                       .argument<int>('i', "input"sv, "required int"sv)
+                       .mutually_exclusive({"json"sv, "yaml"sv})
+                       .at_least_one({"json"sv, "yaml"sv});
+    builder.get_options()->compile();
+    const char* argv[] = {"test", "-j", "-i", "10"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    // provided nodes are collected into in-place bitset
+    ASSERT_EQ(0, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, subcommand_path) {
+    auto run = Builder("run", "run something").flag('v', "verbose", "verbose output");
+    auto builder = Builder("test", "test options").flag('q', "quiet", "quiet output").add_subcommand(run.get_options());
+    const char* argv[] = {"test", "-q", "run", "-v"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(1, result.subcommand_path.size());
+    ASSERT_TRUE(run.get_options()->find_flag('v')->is_set());
+    ASSERT_EQ(0, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, unparsed_arguments) {
+    auto builder = Builder("test", "test options").flag('v', "verbose", "verbose output");
+    const char* argv[] = {"test", "-v", "a", "b", "c", "d", "e", "f", "g", "h"};
+
+    Parser::ProcessResult result;
+    const auto count = count_parse_allocations(builder.get_options(), argv, result);
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ((Parser::UnparsedArguments{"a", "b", "c", "d", "e", "f", "g", "h"}), result.unparsed_arguments);
+    ASSERT_EQ(0, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, many_unparsed_arguments) {
+    auto builder = Builder("test", "test options");
+    std::vector<std::string> values(100000);
+    std::vector<const char*> argv{"test"};
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = std::to_string(i);
+        argv.push_back(values[i].c_str());
+    }
+
+    Parser::ProcessResult result;
+    const auto count = count_allocations(
+        [&] { result = parse_argv(builder.get_options(), static_cast<int>(argv.size()), argv.data()); });
+
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(values.size(), result.unparsed_arguments.size());
+    ASSERT_EQ("99999", result.unparsed_arguments.back());
+    // storage doubles from inline capacity of 8 up to 131072
+    ASSERT_EQ(14, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, interned_strings) {
+    std::vector<std::string> names;
+    for (int idx = 0; idx < 1000; ++idx) {
+        names.push_back("name-" + std::to_string(idx));
+    }
+
+    // node keeps its strings in one buffer until it's added to options
+    std::shared_ptr<Flag> flag;
+    ASSERT_EQ(2, count_allocations([&] { flag = std::make_shared<Flag>('q', "quiet"sv, "quiet output"sv); }));
+
+    // two chunks and the list of them grown twice, lookup table grows as 16, 32, ... 2048
+    details::StringPool pool;
+    const auto count = count_allocations([&] {
+        for (const auto& name : names) {
+            pool.intern(name);
+            pool.intern(name);
+        }
+    });
+    ASSERT_EQ(1000, pool.size());
+    ASSERT_EQ(2, pool.chunks_count());
+    ASSERT_EQ(2 + 2 + 8, count);
+}
+
+TEST(xdx_cliopts_allocations_tests, small_vector_push_back_own_element) {
+    details::SmallVector<std::string_view, 2> values{"a"sv, "b"sv};
+    // every push_back below grows heap storage at least once while referring to the old one
+    for (size_t i = 0; i < 64; ++i) {
+        values.push_back(values[0]);
+        values.emplace_back(values.back());
+    }
+    ASSERT_EQ(130, values.size());
+    ASSERT_EQ("a", values.back());
+    ASSERT_EQ("b", values[1]);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/bulk_convert.hpp>
+#include <xdx/cliopts/value_parser.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+template <class ValueType>
+void expect_same_as_scalar(const std::vector<std::string>& texts) {
+    std::vector<std::string_view> views(texts.begin(), texts.end());
+    std::vector<ValueType> values(texts.size());
+    std::vector<BulkConversionError> errors;
+    const auto converted = convert_bulk(views.data(), views.size(), values.data(), &errors);
+    ASSERT_EQ(texts.size() - errors.size(), converted);
+
+    size_t error_idx = 0;
+    for (size_t idx = 0; idx < texts.size(); ++idx) {
+        std::optional<ValueType> expected;
+        const auto [success, message] = parse_value(views[idx], &expected);
+        if (success) {
+            EXPECT_EQ(*expected, values[idx]) << texts[idx];
+        } else {
+            ASSERT_LT(error_idx, errors.size()) << texts[idx];
+            EXPECT_EQ(idx, errors[error_idx].index) << texts[idx];
+            EXPECT_EQ(message, errors[error_idx].message) << texts[idx];
+            error_idx += 1;
+        }
+    }
+    ASSERT_EQ(errors.size(), error_idx);
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_bulk_convert_tests, integers) {
+    const std::vector<std::string> texts{"0",
+                                         "7",
+                                         "+42",
+                                         "-42",
+                                         "12345678",
+                                         "123456789",
+                                         "2147483647",
+                                         "2147483648",
+                                         "-2147483648",
+                                         "-2147483649",
+                                         "4294967295",
+                                         "9223372036854775807",
+                                         "-9223372036854775808",
+                                         "18446744073709551615",
+                                         "18446744073709551616",
+                                         "0000000000000000000000001",
+                                         "",
+                                         "-",
+                                         "+-1",
+                                         "12a",
+                                         "1234567a",
+                                         "12345678a",
+                                         "x"};
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<int>(texts));
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<unsigned int>(texts));
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<long>(texts));
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<unsigned long>(texts));
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<long long>(texts));
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<unsigned long long>(texts));
+}
+
+TEST(xdx_cliopts_bulk_convert_tests, doubles) {
+    const std::vector<std::string> texts{
+        "0",    "-0",  "1",         "+1.5",     "0.1",  "3.14159", "1e22", "1e23", "1e-22",
+        "2.5E+3", ".5", "1.",     "9007199254740993", "123456789012345678901", "1e", "1e+", "abc",
+        "1.5x", "inf", "1.7976931348623157e308", "4.9e-324", "0.000000000000000000001"};
+    ASSERT_NO_FATAL_FAILURE(expect_same_as_scalar<double>(texts));
+}
+
+// Compares bulk and scalar paths on random input, timings are measured by benchmarks/bulk_convert.bench.cpp.
+TEST(xdx_cliopts_bulk_convert_tests, random_against_scalar) {
+    std::mt19937_64 random{42};
+    std::vector<std::string> integers(200000);
+    std::vector<std::string> doubles(integers.size());
+    for (size_t idx = 0; idx < integers.size(); ++idx) {
+        integers[idx] = std::to_string(random() % 100000000000ull);
+        doubles[idx] = std::to_string(static_cast<double>(random() % 1000000) / 1000);
+    }
+
+    expect_same_as_scalar<unsigned long long>(integers);
+    expect_same_as_scalar<double>(doubles);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/choice.hpp>
+#include <xdx/cliopts/details/perfect_hash.hpp>
+#include <xdx/cliopts/parser.hpp>
+#include <xdx/cliopts/printer.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+enum class Mode
+{
+    Fast,
+    Safe,
+    Paranoid,
+};
+
+}  // namespace
+
+TEST(xdx_cliopts_choice_tests, perfect_hash) {
+    std::vector<std::string> storage;
+    for (size_t i = 0; i < 1000; ++i) {
+        storage.push_back("value-" + std::to_string(i * 7919));
+    }
+    std::vector<std::string_view> keys(storage.begin(), storage.end());
+
+    details::PerfectHash hash(keys);
+    ASSERT_EQ(keys.size(), hash.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(i, hash.find(keys[i]));
+        ASSERT_EQ(keys[i], hash.key(i));
+    }
+    ASSERT_EQ(details::PerfectHash::NPOS, hash.find("value-1"));
+    ASSERT_EQ(details::PerfectHash::NPOS, hash.find(""));
+
+    ASSERT_EQ(details::PerfectHash::NPOS, details::PerfectHash().find("value"));
+    ASSERT_THROW(details::PerfectHash({"a"sv, "b"sv, "a"sv}), std::invalid_argument);
+}
+
+TEST(xdx_cliopts_choice_tests, parse) {
+    auto options = Builder("test", "test options")
+                       .choice<Mode>('m', "mode"sv, "processing mode"sv,
+                                     {{"fast", Mode::Fast}, {"safe", Mode::Safe}, {"paranoid", Mode::Paranoid}},
+                                     Mode::Safe)
+                       .choice<Mode>("check"sv, "check mode"sv, {{"fast", Mode::Fast}, {"safe", Mode::Safe}})
+                       .get_options();
+
+    {
+        const char* argv[] = {"test", "--check", "fast"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(Mode::Safe, options->find_choice<Mode>('m')->get_value());
+        ASSERT_EQ(Mode::Fast, options->find_choice<Mode>("check")->get_value());
+    }
+
+    options->reset_to_default();
+    {
+        const char* argv[] = {"test", "-m", "paranoid", "--check=safe"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(Mode::Paranoid, options->find_choice<Mode>("mode")->get_value());
+        ASSERT_EQ(Mode::Safe, options->find_choice<Mode>("check")->get_value());
+    }
+
+    options->reset_to_default();
+    {
+        const char* argv[] = {"test", "--check", "slow"};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::WrongValueType), result.error);
+        ASSERT_EQ("unexpected value 'slow', expected one of: fast, safe\n", errout.str());
+    }
+
+    options->reset_to_default();
+    {
+        const char* argv[] = {"test", "--mode=fast"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::RequiredArgument), result.error);
+    }
+}
+
+TEST(xdx_cliopts_choice_tests, schema_errors) {
+    Builder builder("test", "test options");
+    ASSERT_THROW(builder.choice<Mode>("mode"sv, "mode"sv, {{"fast", Mode::Fast}, {"fast", Mode::Safe}}),
+                 std::invalid_argument);
+    ASSERT_THROW(builder.choice<Mode>("mode"sv, "mode"sv, {{"fast", Mode::Fast}}, Mode::Safe), std::invalid_argument);
+}
+
+TEST(xdx_cliopts_choice_tests, print) {
+    auto options = Builder("test", "test options")
+                       .choice<Mode>('m', "mode"sv, "processing mode"sv, {{"fast", Mode::Fast}, {"safe", Mode::Safe}},
+                                     Mode::Safe)
+                       .get_options();
+
+    std::ostringstream out;
+    Printer printer(options);
+    printer.print_short(out);
+    ASSERT_EQ("[-m {fast|safe}] ", out.str());
+
+    out.str({});
+    printer.print_long(out);
+    ASSERT_NE(std::string::npos, out.str().find("values: fast, safe\n"));
+    ASSERT_NE(std::string::npos, out.str().find("default: safe\n"));
+}
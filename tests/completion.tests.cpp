@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/completion.hpp>
+
+#include <sstream>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+// git [-q] [-C dir] status [-s] | stash remote [-v]
+OptionsPtr make_git() {
+    auto remote = Builder("remote", "manage remotes").flag('v', "verbose", "be verbose");
+    auto status = Builder("status", "show status").flag('s', "short", "short format");
+    auto stash = Builder("stash", "stash changes").add_subcommand(remote.get_options());
+    return Builder("git", "test options")
+        .flag('q', "quiet", "quiet output")
+        .argument<std::string>('C', "directory"sv, "working directory"sv, false)
+        .add_subcommand(status.get_options())
+        .add_subcommand(stash.get_options())
+        .get_options();
+}
+
+std::string complete(const OptionsPtr& options, std::vector<const char*> argv) {
+    std::ostringstream out;
+    argv.insert(argv.begin(), {"git", Completer::COMMAND.data()});
+    const bool handled = process_completion(options, static_cast<int>(argv.size()), argv.data(), out);
+    EXPECT_TRUE(handled);
+    return out.str();
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_completion_tests, not_completion_request) {
+    const auto options = make_git();
+    const char* argv[] = {"git", "status"};
+    std::ostringstream out;
+    ASSERT_FALSE(process_completion(options, static_cast<int>(std::size(argv)), argv, out));
+    ASSERT_TRUE(out.str().empty());
+}
+
+TEST(xdx_cliopts_completion_tests, subcommands) {
+    const auto options = make_git();
+    ASSERT_EQ("status\nstash\n", complete(options, {}));
+    ASSERT_EQ("status\nstash\n", complete(options, {""}));
+    ASSERT_EQ("status\nstash\n", complete(options, {"st"}));
+    ASSERT_EQ("stash\n", complete(options, {"-q", "stas"}));
+    ASSERT_EQ("remote\n", complete(options, {"-C", "dir", "stash", "r"}));
+    ASSERT_EQ("", complete(options, {"positional", "st"}));
+}
+
+TEST(xdx_cliopts_completion_tests, flags_and_arguments) {
+    const auto options = make_git();
+    ASSERT_EQ("-q\n--quiet\n-C\n--directory\n", complete(options, {"-"}));
+    ASSERT_EQ("--quiet\n--directory\n", complete(options, {"--"}));
+    ASSERT_EQ("--directory\n", complete(options, {"--d"}));
+    ASSERT_EQ("-q\n", complete(options, {"-q"}));
+    ASSERT_EQ("-s\n--short\n", complete(options, {"status", "-"}));
+    ASSERT_EQ("--verbose\n", complete(options, {"stash", "remote", "--v"}));
+}
+
+TEST(xdx_cliopts_completion_tests, argument_value_skips_candidates) {
+    const auto options = make_git();
+    ASSERT_EQ("", complete(options, {"-C", ""}));
+    ASSERT_EQ("", complete(options, {"--directory", "st"}));
+    ASSERT_EQ("status\nstash\n", complete(options, {"--directory=dir", "st"}));
+}
+
+TEST(xdx_cliopts_completion_tests, scripts) {
+    Completer completer(Builder("git", "test options").flag('q', "quiet", "quiet output").get_options());
+    for (auto shell : {Shell::Bash, Shell::Zsh, Shell::Fish}) {
+        std::ostringstream out;
+        completer.print_script(out, shell, "my-tool");
+        const auto script = out.str();
+        ASSERT_NE(std::string::npos, script.find("_my_tool_xdx_complete")) << script;
+        ASSERT_NE(std::string::npos, script.find(Completer::COMMAND)) << script;
+    }
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/multi_call.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+// ls, cp and cat tools with single '-l' flag each, `built` counts materialized tools
+void add_tools(MultiCall& multi_call, size_t& built) {
+    multi_call.add_tool("ls"sv, "list files"sv, [&built] {
+        built += 1;
+        return Builder("ls", "list files").flag('l', "long"sv, "long format"sv).get_options();
+    });
+    multi_call.add_tool("cp"sv, "copy files"sv, [&built] {
+        built += 1;
+        return Builder("cp", "copy files").flag('l', "link"sv, "link instead of copy"sv).get_options();
+    });
+    multi_call.add_tool("cat"sv, "print files"sv, [&built] {
+        built += 1;
+        return Builder("cat", "print files").flag('l', "long"sv, "number lines"sv).get_options();
+    });
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_multi_call_tests, basename) {
+    ASSERT_EQ("ls", MultiCall::basename("/usr/bin/ls"));
+    ASSERT_EQ("ls", MultiCall::basename("C:\\tools\\ls"));
+    ASSERT_EQ("ls", MultiCall::basename("ls"));
+    ASSERT_EQ("", MultiCall::basename("bin/"));
+}
+
+TEST(xdx_cliopts_multi_call_tests, dispatch) {
+    size_t built = 0;
+    MultiCall multi_call("box");
+    add_tools(multi_call, built);
+    ASSERT_THROW(multi_call.add_tool("ls"sv, "duplicate"sv, [] { return OptionsPtr{}; }), std::invalid_argument);
+    ASSERT_EQ(3, multi_call.tools_count());
+    ASSERT_EQ(nullptr, multi_call.find_tool("rm"));
+    ASSERT_EQ(0, built);
+
+    {
+        const char* argv[] = {"/usr/bin/cp", "-l", "a"};
+        auto result = multi_call.process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.parsed.error));
+        ASSERT_EQ("cp", result.tool->get_name());
+        ASSERT_TRUE(result.tool->find_flag('l')->is_set());
+        ASSERT_EQ(Parser::UnparsedArguments{"a"}, result.parsed.unparsed_arguments);
+        ASSERT_EQ(1, built);
+        ASSERT_FALSE(multi_call.find_tool("ls")->is_materialized());
+    }
+
+    {
+        const char* argv[] = {"./box", "cat", "--long"};
+        auto result = multi_call.process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.parsed.error));
+        ASSERT_EQ("cat", result.tool->get_name());
+        ASSERT_TRUE(result.tool->find_flag("long")->is_set());
+        ASSERT_EQ(2, built);
+    }
+}
+
+TEST(xdx_cliopts_multi_call_tests, unknown_tool) {
+    size_t built = 0;
+    MultiCall multi_call("box");
+    add_tools(multi_call, built);
+
+    auto process = [&multi_call](std::vector<const char*> argv) {
+        std::ostringstream errout;
+        auto result = multi_call.process({static_cast<int>(argv.size()), argv.data()}, errout);
+        EXPECT_EQ(nullptr, result.tool);
+        EXPECT_EQ(make_error_code(ProcessingArgumentsError::UnknownSubcommand), result.parsed.error);
+        return errout.str();
+    };
+
+    ASSERT_EQ("Unknown tool 'rm', available: ls cp cat\n", process({"/bin/rm", "-l"}));
+    ASSERT_EQ("Unknown tool 'rm', available: ls cp cat\n", process({"box", "rm"}));
+    ASSERT_EQ("Expected tool name, available: ls cp cat\n", process({"box"}));
+    // only binary called by own name takes tool from the first argument
+    ASSERT_EQ("Unknown tool 'foo', available: ls cp cat\n", process({"/bin/foo", "ls"}));
+    ASSERT_EQ(0, built);
+}
+
+TEST(xdx_cliopts_multi_call_tests, parser_settings) {
+    size_t built = 0;
+    MultiCall multi_call("box");
+    add_tools(multi_call, built);
+    const auto parser = Parser(nullptr).allow_long_abbreviations().write_diagnostics(false);
+
+    {
+        const char* argv[] = {"ls", "--lo"};
+        auto result = multi_call.process({static_cast<int>(std::size(argv)), argv}, parser);
+        ASSERT_FALSE(static_cast<bool>(result.parsed.error));
+        ASSERT_TRUE(result.tool->find_flag("long")->is_set());
+    }
+
+    {
+        const char* argv[] = {"rm"};
+        std::ostringstream errout;
+        auto result = multi_call.process({static_cast<int>(std::size(argv)), argv}, parser, errout);
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::UnknownSubcommand), result.parsed.error);
+        ASSERT_EQ(1, result.parsed.diagnostics.size());
+        ASSERT_EQ("", errout.str());
+    }
+}
@@ -2,8 +2,14 @@
 
 #include <xdx/cliopts/builder.hpp>
 #include <xdx/cliopts/options.hpp>
+#include <xdx/cliopts/parser.hpp>
 #include <xdx/cliopts/printer.hpp>
 
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 using namespace xdx::cliopts;
 
 TEST(xdx_cliopts_options_tests, empty_list) {
@@ -32,3 +38,270 @@ TEST(xdx_cliopts_options_tests, empty_list) {
     printer.print_long(std::cout);
     std::cout << std::endl;
 }
+
+TEST(xdx_cliopts_options_tests, lazy_subcommands) {
+    using namespace std;
+    size_t built = 0;
+    auto factory = [&built](std::string_view name) {
+        return [&built, name] {
+            built += 1;
+            return Builder(name, "lazy subcommand"sv).flag('v', "verbose"sv, "verbose output"sv).get_options();
+        };
+    };
+
+    auto builder = Builder("test", "test options")
+                       .add_subcommand("build"sv, "build something"sv, factory("build"sv))
+                       .add_subcommand("run"sv, "run something"sv, factory("run"sv));
+    auto options = builder.get_options();
+
+    std::ostringstream out;
+    Printer printer(options);
+    printer.print_short(out);
+    printer.print_long(out);
+    options->reset_to_default();
+    ASSERT_EQ(0, built);
+
+    const char* argv[] = {"test", "run", "-v"};
+    auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ(1, built);
+
+    auto run = std::static_pointer_cast<LazyOptions>(options->find_subcommand("run"));
+    auto build = std::static_pointer_cast<LazyOptions>(options->find_subcommand("build"));
+    ASSERT_TRUE(run->is_materialized());
+    ASSERT_FALSE(build->is_materialized());
+    ASSERT_TRUE(run->find_flag('v')->is_set());
+
+    Printer(build).print_long(out);
+    ASSERT_EQ(2, built);
+    ASSERT_TRUE(build->is_materialized());
+    ASSERT_EQ("build", build->get_name());
+}
+
+TEST(xdx_cliopts_options_tests, lazy_subcommand_factory_failure) {
+    using namespace std;
+    size_t calls = 0;
+    auto options = Builder("test", "test options")
+                       .add_subcommand("run"sv, "run something"sv,
+                                       [&calls]() -> OptionsPtr {
+                                           calls += 1;
+                                           // duplicate names make Builder throw
+                                           return Builder("run"sv, "run something"sv)
+                                               .flag('v', "verbose"sv, "verbose output"sv)
+                                               .flag('v', "version"sv, "print version"sv)
+                                               .get_options();
+                                       })
+                       .add_subcommand("build"sv, "build something"sv, [] { return OptionsPtr{}; })
+                       .get_options();
+
+    const char* argv[] = {"test", "run", "-v"};
+    ASSERT_THROW(parse_argv(options, static_cast<int>(std::size(argv)), argv), std::invalid_argument);
+
+    // factory is kept until it succeeds, so the failure repeats instead of leaving empty options
+    auto run = options->find_subcommand("run");
+    ASSERT_THROW(run->find_flag('v'), std::invalid_argument);
+    ASSERT_EQ(2, calls);
+    ASSERT_THROW(options->find_subcommand("build")->flags_count(), std::logic_error);
+}
+
+namespace
+{
+
+class UserFlag : public FlagBase
+{
+public:
+    using FlagBase::FlagBase;
+
+    bool is_countable() const noexcept final {
+        return false;
+    }
+
+    void set_found() noexcept final {
+        found_ = true;
+    }
+
+    bool is_set() const noexcept final {
+        return found_;
+    }
+
+    void reset_to_default() noexcept final {
+        found_ = false;
+    }
+
+private:
+    bool found_ = false;
+};
+
+}  // namespace
+
+TEST(xdx_cliopts_options_tests, closed_set_refs) {
+    bool bound = false;
+    auto builder = Builder("test", "test options")
+                       .flag('v', "verbose", "verbose output")
+                       .flag_count('q', "quiet output")
+                       .flag(&bound, 'b', "bound flag")
+                       .argument<int>('i', "input", "input value", false)
+                       .argument_list<std::string>('s', "string values")
+                       .argument<char>('c', "separator", "separator char", false);
+    auto options = builder.get_options();
+    options->add(std::make_shared<UserFlag>('u', "user flag"));
+
+    ASSERT_FALSE(options->find_flag_ref('v').is_generic());
+    ASSERT_FALSE(options->find_flag_ref('q').is_generic());
+    ASSERT_FALSE(options->find_flag_ref('b').is_generic());
+    ASSERT_FALSE(options->find_argument_ref('i').is_generic());
+    ASSERT_FALSE(options->find_argument_ref('s').is_generic());
+    ASSERT_EQ(options->find_flag("verbose").get(), options->find_flag_ref("verbose").get());
+    ASSERT_FALSE(static_cast<bool>(options->find_flag_ref('x')));
+    ASSERT_FALSE(static_cast<bool>(options->find_argument_ref("verbose")));
+
+    // user implementations stay behind the virtual interface
+    auto user = options->find_flag_ref('u');
+    ASSERT_TRUE(user.is_generic());
+    ASSERT_EQ(options->find_flag('u').get(), user.get());
+    // and so do built-in kinds of value types outside of the closed set
+    ASSERT_TRUE(options->find_argument_ref('c').is_generic());
+    ASSERT_EQ(options->find_argument('c').get(), options->find_argument_ref('c').get());
+
+    const char* argv[] = {"test", "-vqqbu", "-i", "3", "-s", "x"};
+    auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_TRUE(options->find_flag('v')->is_set());
+    ASSERT_EQ(2, options->find_flag_count('q')->get_count());
+    ASSERT_TRUE(bound);
+    ASSERT_TRUE(options->find_flag('u')->is_set());
+    ASSERT_EQ(3, options->find_typed_argument<int>('i')->get_value());
+    ASSERT_EQ(std::vector<std::string>{"x"}, options->find_typed_argument_list<std::string>('s')->get_values());
+}
+
+TEST(xdx_cliopts_options_tests, interned_strings) {
+    auto options = std::make_shared<Options>(std::string("test"), std::string("test options"));
+
+    for (int idx = 0; idx < 100; ++idx) {
+        auto argument = std::make_shared<Argument<int>>("input-" + std::to_string(idx), "input value");
+        argument->set_type_name(std::string("INT"));
+        options->add(argument);
+    }
+    options->add(std::make_shared<Flag>('v', std::string("verbose"), std::string("verbose output")));
+
+    ASSERT_EQ("test", options->get_name());
+    ASSERT_EQ("test options", options->get_description());
+    ASSERT_EQ("input-42", options->get_argument(42)->get_long_name());
+    ASSERT_EQ("verbose output", options->find_flag("verbose")->get_description());
+
+    // description and type name are shared by all arguments
+    const auto& strings = options->get_strings();
+    ASSERT_EQ(2 + 100 + 2 + 2, strings->size());
+    ASSERT_EQ(1, strings->chunks_count());
+    ASSERT_EQ(options->get_argument(0)->get_type_name().data(), options->get_argument(99)->get_type_name().data());
+    ASSERT_EQ(options->get_argument(0)->get_description().data(),
+              options->get_argument(99)->get_description().data());
+
+    // nodes outside of options own their strings
+    auto flag = std::make_shared<Flag>('q', std::string("quiet"), std::string("quiet output"));
+    ASSERT_EQ("quiet", flag->get_long_name());
+    ASSERT_EQ("quiet output", flag->get_description());
+
+    // subcommands move their strings into pool of the tree they are added to
+    auto remote = std::make_shared<Options>(std::string("remote"), std::string("manage remotes"));
+    remote->add(std::make_shared<Flag>('v', std::string("verbose"), std::string("verbose output")));
+    auto stash = std::make_shared<Options>(std::string("stash"), std::string("stash changes"));
+    stash->add(remote);
+    ASSERT_EQ(stash->get_strings(), remote->get_strings());
+    options->add(stash);
+    ASSERT_EQ(strings, stash->get_strings());
+    ASSERT_EQ(strings, remote->get_strings());
+    ASSERT_EQ(2 + 100 + 2 + 2 + 4, strings->size());
+    ASSERT_EQ(options->find_flag("verbose")->get_long_name().data(), remote->get_flag(0)->get_long_name().data());
+    ASSERT_EQ(remote->get_flag(0), remote->find_flag("verbose"));
+    ASSERT_EQ(remote, options->find_subcommand("stash")->find_subcommand("remote"));
+    ASSERT_THROW(stash->add(std::make_shared<Options>(std::string("remote"), std::string(""))),
+                 std::invalid_argument);
+}
+
+TEST(xdx_cliopts_options_tests, compiled_layout) {
+    auto run = Builder("run", "run something").argument<int>('n', "count", "run count");
+    auto builder = Builder("test", "test options")
+                       .flag('v', "verbose", "verbose output")
+                       .argument<int>('i', "input", "required input")
+                       .argument<int>('o', "output", "optional output", false)
+                       .argument<int>("level", "required level")
+                       .add_subcommand(run.get_options());
+    auto options = builder.get_options();
+
+    ASSERT_THROW(builder.flag('i', "duplicated short name"), std::invalid_argument);
+    ASSERT_THROW(builder.flag("output", "duplicated long name"), std::invalid_argument);
+
+    ASSERT_EQ(0, options->find_missing_required(0));
+    options->compile();
+    ASSERT_TRUE(options->is_compiled());
+    ASSERT_TRUE(run.get_options()->is_compiled());
+    ASSERT_THROW(builder.flag('x', "too late"), std::logic_error);
+
+    ASSERT_EQ(options->find_flag("verbose"), options->find_flag('v'));
+    ASSERT_EQ(nullptr, options->find_flag('i'));
+    ASSERT_EQ(options->get_argument(1), options->find_argument('o'));
+    ASSERT_EQ(0, options->find_missing_required(0));
+    ASSERT_EQ(2, options->find_missing_required(1));
+
+    {
+        const char* argv[] = {"test", "-i", "1", "run"};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::RequiredArgument,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("Argument '--level' required value\n", errout.str());
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "-v", "-i", "1", "--level", "2", "run", "-n", "3"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(2, options->find_typed_argument<int>("level")->get_value());
+        ASSERT_EQ(3, run.get_options()->find_typed_argument<int>('n')->get_value());
+    }
+}
+
+// Registration of generated schema with duplicate checks, startup time is measured by
+// benchmarks/large_schema.bench.cpp.
+TEST(xdx_cliopts_options_tests, large_schema) {
+    constexpr size_t COUNT = 5000;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 2 * COUNT; ++i) {
+        names.push_back("option-" + std::to_string(i));
+    }
+
+    std::vector<FlagSpec> flags;
+    std::vector<ArgumentSpec<int>> arguments;
+    for (size_t i = 0; i < COUNT; ++i) {
+        flags.push_back({'\0', names[2 * i], "generated flag", i % 2 == 0});
+        arguments.push_back({'\0', names[2 * i + 1], "generated argument"});
+    }
+    flags[0].short_name = 'f';
+    flags[COUNT - 1].short_name = 'z';
+    arguments[0].short_name = 'a';
+
+    auto builder = Builder("test", "generated options").flags(flags).arguments<int>(arguments);
+    for (size_t i = 0; i < 100; ++i) {
+        builder.add_subcommand(Builder("sub-" + std::to_string(i), "generated subcommand").get_options());
+    }
+    builder.get_options()->compile();
+
+    auto options = builder.get_options();
+    ASSERT_EQ(COUNT, options->flags_count());
+    ASSERT_EQ(COUNT, options->arguments_count());
+    ASSERT_EQ(options->get_flag(0), options->find_flag('f'));
+    ASSERT_EQ(options->get_flag(COUNT - 1), options->find_flag('z'));
+    ASSERT_EQ(nullptr, options->find_flag('y'));
+    ASSERT_EQ(options->get_argument(0), options->find_argument('a'));
+    ASSERT_NE(nullptr, options->find_flag_count(names[2 * (COUNT - 2)]));
+    ASSERT_EQ(options->get_argument(COUNT - 1), options->find_argument(names[2 * COUNT - 1]));
+
+    Builder duplicates("test", "duplicated names");
+    duplicates.flags({{'x', "first", "flag"}});
+    ASSERT_THROW(duplicates.flags({{'\0', "first", "flag"}}), std::invalid_argument);
+    ASSERT_THROW(duplicates.arguments<int>({{'x', "second", "argument"}}), std::invalid_argument);
+    duplicates.add_subcommand(Builder("sub", "subcommand").get_options());
+    ASSERT_THROW(duplicates.add_subcommand(Builder("sub", "subcommand").get_options()), std::invalid_argument);
+}
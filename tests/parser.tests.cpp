@@ -2,7 +2,43 @@
 
 #include <xdx/cliopts/cliopts.hpp>
 
+#include <sstream>
+
 using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+struct ByteSize
+{
+    size_t bytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, const ByteSize& size) {
+    return out << size.bytes << 'B';
+}
+
+}  // namespace
+
+template <>
+struct xdx::cliopts::ValueParser<ByteSize>
+{
+    static std::pair<bool, std::string> parse(std::string_view text, std::optional<ByteSize>* value) {
+        size_t multiplier = 1;
+        if (!text.empty() && text.back() == 'K') {
+            multiplier = 1024;
+            text.remove_suffix(1);
+        }
+
+        std::optional<size_t> bytes;
+        auto result = parse_value(text, &bytes);
+        if (result.first) {
+            *value = ByteSize{*bytes * multiplier};
+        }
+        return result;
+    }
+};
 
 TEST(xdx_cliopts_parser_tests, empty_options) {
     const char* argv[] = {"test"};
@@ -133,3 +169,575 @@ TEST(xdx_cliopts_parser_tests, options_required_arguments) {
         ASSERT_EQ(ProcessingArgumentsError::RequiredArgument, error_value);
     }
 }
+
+TEST(xdx_cliopts_parser_tests, subcommand_abbreviations) {
+    auto status = Builder("status", "show status").flag('s', "short", "short format");
+    auto stash = Builder("stash", "stash changes");
+    auto show = Builder("show", "show object");
+    auto builder = Builder("test", "test options")
+                       .add_subcommand(status.get_options())
+                       .add_subcommand(stash.get_options())
+                       .add_subcommand(show.get_options());
+    auto options = builder.get_options();
+
+    ASSERT_EQ(stash.get_options(), options->find_subcommand("stash"));
+    ASSERT_EQ(nullptr, options->find_subcommand("sta"));
+    ASSERT_EQ(3, options->find_subcommand_prefix("s").first);
+    ASSERT_EQ(2, options->find_subcommand_prefix("sta").first);
+    ASSERT_EQ(nullptr, options->find_subcommand_prefix("sta").second);
+    ASSERT_EQ(status.get_options(), options->find_subcommand_prefix("statu").second);
+    ASSERT_EQ(0, options->find_subcommand_prefix("x").first);
+
+    {
+        const char* argv[] = {"test", "stat", "-s"};
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_TRUE(static_cast<bool>(result.error));
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "stat", "-s"};
+        auto result =
+            Parser(options).allow_subcommand_abbreviations().process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(1, result.subcommand_path.size());
+        ASSERT_EQ("status", result.subcommand_path[0]);
+        ASSERT_TRUE(status.get_options()->find_flag('s')->is_set());
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "sh"};
+        auto result =
+            Parser(options).allow_subcommand_abbreviations().process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ("show", result.subcommand_path[0]);
+    }
+
+    {
+        const char* argv[] = {"test", "st"};
+        std::ostringstream errout;
+        auto result = Parser(options).allow_subcommand_abbreviations().process(
+            {static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_TRUE(static_cast<bool>(result.error));
+        ASSERT_EQ(ProcessingArgumentsError::AmbiguousSubcommand,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_NE(std::string::npos, errout.str().find("status stash"));
+    }
+
+    {
+        Builder single("single", "");
+        Builder only("only", "");
+        single.add_subcommand(only.get_options());
+
+        const char* argv[] = {"test", ""};
+        auto result = Parser(single.get_options())
+                          .allow_subcommand_abbreviations()
+                          .process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(result.subcommand_path.empty());
+        ASSERT_EQ((Parser::UnparsedArguments{""}), result.unparsed_arguments);
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, long_name_abbreviations) {
+    auto builder = Builder("test", "test options")
+                       .flag("verbose", "verbose output")
+                       .flag("verbatim", "verbatim output")
+                       .flag_count('q', "quiet", "quiet output")
+                       .argument<int>("version"sv, "required version"sv, false)
+                       .argument<int>("jobs"sv, "jobs count"sv, 1);
+    auto options = builder.get_options();
+
+    ASSERT_EQ(3, std::get<0>(options->find_long_name_prefix("ver")));
+    ASSERT_EQ(2, std::get<0>(options->find_long_name_prefix("verb")));
+    ASSERT_EQ(options->find_flag("verbose"), std::get<1>(options->find_long_name_prefix("verbo")));
+    ASSERT_EQ(options->find_argument("version"), std::get<2>(options->find_long_name_prefix("vers")));
+    ASSERT_EQ(0, std::get<0>(options->find_long_name_prefix("x")));
+
+    // index built by the first prefix lookup follows later additions
+    auto extended = Builder("test", "test options").flag("verbose", "verbose output");
+    ASSERT_EQ(1, std::get<0>(extended.get_options()->find_long_name_prefix("verb")));
+    extended.argument<int>("verbosity"sv, "verbosity level"sv, 1);
+    ASSERT_EQ(2, std::get<0>(extended.get_options()->find_long_name_prefix("verb")));
+    ASSERT_EQ(extended.get_options()->find_argument("verbosity"),
+              std::get<2>(extended.get_options()->find_long_name_prefix("verbosi")));
+
+    {
+        const char* argv[] = {"test", "--verbo"};
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_EQ(ProcessingArgumentsError::UnknonwSwitcher,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "--verbo", "--qu", "--quiet", "--vers=3", "--j", "4"};
+        auto result = Parser(options).allow_long_abbreviations().process({static_cast<int>(std::size(argv)), argv});
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(options->find_flag("verbose")->is_set());
+        ASSERT_FALSE(options->find_flag("verbatim")->is_set());
+        ASSERT_EQ(2, options->find_flag_count("quiet")->get_count());
+        ASSERT_EQ(3, options->find_typed_argument<int>("version")->get_value());
+        ASSERT_EQ(4, options->find_typed_argument<int>("jobs")->get_value());
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "--verb"};
+        std::ostringstream errout;
+        auto result =
+            Parser(options).allow_long_abbreviations().process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::AmbiguousSwitcher,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_NE(std::string::npos, errout.str().find("--verbose --verbatim"));
+    }
+
+    // empty long name is prefix of every name, but abbreviates none of them
+    ASSERT_EQ(0, std::get<0>(options->find_long_name_prefix("")));
+    auto single = Builder("test", "test options").flag("verbose", "verbose output").get_options();
+    auto pair = Builder("test", "test options")
+                    .flag("verbose", "verbose output")
+                    .flag("quiet", "quiet output")
+                    .get_options();
+    for (const auto& empty_options : {single, pair}) {
+        const char* argv[] = {"test", "--"};
+        std::ostringstream errout;
+        auto result = Parser(empty_options)
+                          .allow_long_abbreviations()
+                          .process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::UnknonwSwitcher,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_FALSE(empty_options->find_flag("verbose")->is_set());
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, pass_through) {
+    auto run = Builder("run", "run something").flag('f', "force", "force run");
+    auto builder = Builder("test", "test options")
+                       .flag('v', "verbose", "verbose output")
+                       .argument<int>('j', "jobs"sv, "jobs count"sv, 1)
+                       .add_subcommand(run.get_options());
+    auto options = builder.get_options();
+
+    {
+        char arg0[] = "test", arg1[] = "-v", arg2[] = "--gst-debug=3", arg3[] = "-j", arg4[] = "4", arg5[] = "-x",
+             arg6[] = "run", arg7[] = "file", arg8[] = "--force", arg9[] = "--np";
+        char* argv[] = {arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9};
+        int argc = static_cast<int>(std::size(argv));
+
+        auto result = parse_argv_pass_through(options, argc, argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(options->find_flag('v')->is_set());
+        ASSERT_EQ(4, options->find_typed_argument<int>('j')->get_value());
+        ASSERT_TRUE(run.get_options()->find_flag('f')->is_set());
+        ASSERT_EQ((Parser::SubcommandsPath{"run"}), result.subcommand_path);
+        ASSERT_EQ((Parser::UnparsedArguments{"file"}), result.unparsed_arguments);
+
+        ASSERT_EQ(5, argc);
+        ASSERT_EQ((std::vector<std::string_view>{"test", "--gst-debug=3", "-x", "file", "--np"}),
+                  std::vector<std::string_view>(argv, argv + argc));
+        ASSERT_EQ(nullptr, argv[argc]);
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "-j", "many", "-x"};
+        int argc = static_cast<int>(std::size(argv));
+        std::ostringstream errout;
+        auto result = Parser(options).process_pass_through(argc, argv, errout);
+        ASSERT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ(4, argc);
+        ASSERT_EQ("-j"sv, argv[1]);
+    }
+
+    for (auto group : {"-vx", "-xv", "-xj4"}) {
+        const char* argv[] = {"test", "-y", group};
+        int argc = static_cast<int>(std::size(argv));
+        std::ostringstream errout;
+        auto result = Parser(options).process_pass_through(argc, argv, errout);
+        ASSERT_EQ(ProcessingArgumentsError::UnknonwSwitcher,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("-x", result.diagnostics.front().name);
+        ASSERT_EQ(3, argc);
+        options->reset_to_default();
+    }
+
+    {
+        // value of unknown switch is kept as positional, so `run` isn't taken as subcommand after it
+        const char* argv[] = {"test", "-xy", "--level", "2", "run"};
+        int argc = static_cast<int>(std::size(argv));
+        std::ostringstream errout;
+        auto result = Parser(options).process_pass_through(argc, argv, errout);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(result.subcommand_path.empty());
+        ASSERT_EQ((Parser::UnparsedArguments{"2", "run"}), result.unparsed_arguments);
+        ASSERT_EQ(5, argc);
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, bound_storage) {
+    bool verbose = false;
+    size_t quiet = 0;
+    int jobs = 1;
+    std::string name;
+    std::vector<int> ids{7};
+    std::vector<double> ratios;
+
+    auto builder = Builder("test", "test options")
+                       .flag(&verbose, 'v', "verbose", "verbose output")
+                       .flag_count(&quiet, 'q', "quiet output")
+                       .argument(&jobs, 'j', "jobs"sv, "jobs count"sv)
+                       .argument(&name, "name"sv, "required name"sv, true)
+                       .argument_list(&ids, 'i', "id"sv, "ids"sv)
+                       .argument_list(&ratios, "ratio"sv, "ratios"sv);
+    auto options = builder.get_options();
+    ASSERT_EQ("1", options->find_argument('j')->get_default_value());
+    ASSERT_EQ("7", options->find_argument('i')->get_default_value());
+    ASSERT_FALSE(options->find_argument("ratio")->has_default_value());
+
+    {
+        const char* argv[] = {"test", "-vqq", "--name=x", "-j", "4", "-i", "1", "--id=2", "--ratio", "0.5"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(verbose);
+        ASSERT_EQ(2, quiet);
+        ASSERT_EQ(4, jobs);
+        ASSERT_EQ("x", name);
+        ASSERT_EQ((std::vector<int>{1, 2}), ids);
+        ASSERT_EQ((std::vector<double>{0.5}), ratios);
+        ASSERT_TRUE(options->find_flag('q')->is_countable());
+    }
+
+    options->reset_to_default();
+    ASSERT_FALSE(verbose);
+    ASSERT_EQ(0, quiet);
+    ASSERT_EQ(1, jobs);
+    ASSERT_EQ((std::vector<int>{7}), ids);
+    ASSERT_TRUE(ratios.empty());
+
+    {
+        const char* argv[] = {"test", "-j", "2"};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::RequiredArgument,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+    }
+
+    // defaults survive repeated parses, they are moved aside rather than copied back
+    std::string mode = "fast";
+    std::vector<std::string> tags{"a", "b"};
+    auto defaults = Builder("test", "test options")
+                        .argument(&mode, "mode"sv, "mode"sv)
+                        .argument_list(&tags, "tag"sv, "tags"sv)
+                        .get_options();
+    for (int round = 0; round < 2; ++round) {
+        const char* argv[] = {"test", "--mode=slow", "--tag", "c"};
+        auto result = parse_argv(defaults, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ("slow", mode);
+        ASSERT_EQ((std::vector<std::string>{"c"}), tags);
+
+        defaults->reset_to_default();
+        ASSERT_EQ("fast", mode);
+        ASSERT_EQ((std::vector<std::string>{"a", "b"}), tags);
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, value_parsers) {
+    auto builder = Builder("test", "test options")
+                       .argument<ByteSize>('b', "buffer"sv, "buffer size"sv, ByteSize{64})
+                       .argument_list<ByteSize>('c', "chunk"sv, "chunk sizes"sv, false)
+                       .argument<short>('s', "short"sv, "short value"sv, false)
+                       .argument<unsigned>('u', "unsigned"sv, "unsigned value"sv, false)
+                       .argument<double>('d', "double"sv, "double value"sv, false);
+    auto options = builder.get_options();
+    ASSERT_EQ("64B", options->find_argument('b')->get_default_value());
+
+    {
+        const char* argv[] = {"test", "-b", "4K", "-c", "1", "-c", "2K", "-s", "+12", "-u", "7", "-d", "1e-3"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(4096, options->find_typed_argument<ByteSize>('b')->get_value().bytes);
+        const auto chunks = options->find_typed_argument_list<ByteSize>('c')->get_values();
+        ASSERT_EQ(2, chunks.size());
+        ASSERT_EQ(2048, chunks[1].bytes);
+        ASSERT_EQ(12, options->find_typed_argument<short>('s')->get_value());
+        ASSERT_EQ(7, options->find_typed_argument<unsigned>('u')->get_value());
+        ASSERT_EQ(1e-3, options->find_typed_argument<double>('d')->get_value());
+        options->reset_to_default();
+    }
+
+    auto parse_error = [&options](const char* name, const char* value) {
+        const auto entry = "--"s + name + "=" + value;
+        const char* argv[] = {"test", entry.c_str()};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        options->reset_to_default();
+        EXPECT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        return errout.str();
+    };
+
+    ASSERT_EQ("out of range\n", parse_error("short", "40000"));
+    ASSERT_EQ("not a number\n", parse_error("unsigned", "-1"));
+    ASSERT_EQ("unexpected trailing chars\n", parse_error("double", "1.5x"));
+    ASSERT_EQ("unexpected trailing chars\n", parse_error("buffer", "4M"));
+    ASSERT_EQ("unexpected trailing chars\n", parse_error("unsigned", "7 "));
+    ASSERT_EQ("not a number\n", parse_error("short", " "));
+
+    {
+        // leading whitespace is skipped as stoi & co. did
+        const char* argv[] = {"test", "-s", " 42", "-u", "\t+7", "-d", " -0.5"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(42, options->find_typed_argument<short>('s')->get_value());
+        ASSERT_EQ(7, options->find_typed_argument<unsigned>('u')->get_value());
+        ASSERT_EQ(-0.5, options->find_typed_argument<double>('d')->get_value());
+        options->reset_to_default();
+    }
+
+    static_assert(details::is_plain_integer_v<long long>);
+    static_assert(!details::is_plain_integer_v<char> && !details::is_plain_integer_v<unsigned char>);
+    static_assert(!details::is_plain_integer_v<wchar_t> && !details::is_plain_integer_v<char16_t> &&
+                  !details::is_plain_integer_v<char32_t>);
+}
+
+TEST(xdx_cliopts_parser_tests, delimited_lists) {
+    std::vector<std::string> names;
+    auto builder = Builder("test", "test options")
+                       .argument_list<int>('i', "ids"sv, "ids"sv)
+                       .argument_list(&names, 'n', "names"sv, "names"sv);
+    auto options = builder.get_options();
+    options->find_typed_argument_list<int>("ids")->set_delimiter(',');
+    std::dynamic_pointer_cast<BoundArgumentList<std::string>>(options->find_argument('n'))->set_delimiter(':', '\\');
+
+    {
+        const char* argv[] = {"test", "--ids=1,2,3", "-i", "4", "-n", "a:b\\:c", "--names=d"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ((std::vector<int>{1, 2, 3, 4}), options->find_typed_argument_list<int>('i')->get_values());
+        ASSERT_EQ((std::vector<std::string>{"a", "b:c", "d"}), names);
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"test", "--ids=1,two,3"};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("not a number\n", errout.str());
+    }
+
+    {
+        // escaping is opt-in, so backslashes of paths survive
+        std::vector<std::string> paths;
+        auto path_options =
+            Builder("test", "test options").argument_list(&paths, 'p', "paths"sv, "paths"sv).get_options();
+        std::dynamic_pointer_cast<BoundArgumentList<std::string>>(path_options->find_argument('p'))
+            ->set_delimiter(',');
+        const char* argv[] = {"test", "-p", "C:\\a,C:\\b\\"};
+        auto result = parse_argv(path_options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ((std::vector<std::string>{"C:\\a", "C:\\b\\"}), paths);
+    }
+
+    {
+        // failed occurrence leaves bound vector as it was
+        std::vector<int> values{7};
+        BoundArgumentList<int> ids(&values, "ids"sv, "ids"sv);
+        ids.set_delimiter(',');
+        ASSERT_FALSE(ids.set_string_value("1,x").first);
+        ASSERT_EQ((std::vector<int>{7}), values);
+        ASSERT_FALSE(ids.has_value());
+        ASSERT_TRUE(ids.set_string_value("1,2").first);
+        ASSERT_TRUE(ids.set_string_value("3").first);
+        ASSERT_EQ((std::vector<int>{1, 2, 3}), values);
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, constraints) {
+    auto options = Builder("test", "test options")
+                       .flag('j', "json"sv, "json output"sv)
+                       .flag("yaml"sv, "yaml output"sv)
+                       .argument<std::string>('o', "output"sv, "output file"sv, false)
+                       .argument<std::string>("format"sv, "output format"sv, false)
+                       .argument<std::string>('i', "input"sv, "input file"sv, false)
+                       .flag("stdin"sv, "read stdin"sv)
+                       .argument<int>("jobs"sv, "jobs"sv, true)
+                       .mutually_exclusive({"j"sv, "yaml"sv})
+                       .depends_on("output"sv, {"format"sv, "json"sv})
+                       .at_least_one({"input"sv, "stdin"sv})
+                       .get_options();
+    ASSERT_THROW(std::static_pointer_cast<Options>(options)->add_at_least_one({"unknown"sv}), std::invalid_argument);
+
+    auto parse = [&options](std::vector<const char*> argv, std::string* messages) {
+        argv.insert(argv.begin(), "test");
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(argv.size()), argv.data()}, errout);
+        options->reset_to_default();
+        *messages = errout.str();
+        return result.error;
+    };
+
+    for (bool compiled : {false, true}) {
+        if (compiled) {
+            options->compile();
+        }
+
+        std::string messages;
+        ASSERT_FALSE(parse({"--jobs=1", "--stdin", "-j", "-o", "out", "--format=x"}, &messages));
+        ASSERT_FALSE(parse({"--jobs=1", "-i", "in", "--yaml"}, &messages));
+
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::MutuallyExclusive),
+                  parse({"--jobs=1", "--stdin", "-j", "--yaml"}, &messages));
+        ASSERT_EQ("Switchers '--json', '--yaml' can't be used together\n", messages);
+
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::MissingDependency),
+                  parse({"--jobs=1", "--stdin", "--output", "out"}, &messages));
+        ASSERT_EQ("Switcher '--output' requires '--json', '--format'\n", messages);
+
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::AtLeastOneRequired),
+                  parse({"--jobs=1", "--yaml"}, &messages));
+        ASSERT_EQ("One of '--input', '--stdin' is required\n", messages);
+
+        // required arguments are reported before constraints
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::RequiredArgument), parse({"--yaml"}, &messages));
+        ASSERT_EQ("Argument '--jobs' required value\n", messages);
+    }
+}
+
+namespace
+{
+
+// counts writes and flushes which reach the stream buffer
+class CountingBuffer : public std::stringbuf
+{
+public:
+    size_t writes = 0;
+    size_t flushes = 0;
+
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        writes += 1;
+        return std::stringbuf::xsputn(data, count);
+    }
+
+    int sync() override {
+        flushes += 1;
+        return std::stringbuf::sync();
+    }
+};
+
+}  // namespace
+
+TEST(xdx_cliopts_parser_tests, diagnostics) {
+    auto options = Builder("test", "test options")
+                       .argument<int>('a', "alpha"sv, "alpha"sv)
+                       .argument<int>('b', "beta"sv, "beta"sv)
+                       .argument<int>('c', "gamma"sv, "gamma"sv)
+                       .get_options();
+
+    {
+        CountingBuffer buffer;
+        std::ostream errout(&buffer);
+        const char* argv[] = {"test"};
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::RequiredArgument), result.error);
+        ASSERT_EQ(3, result.diagnostics.size());
+        ASSERT_EQ(DiagnosticId::RequiredArgument, result.diagnostics[1].id);
+        ASSERT_EQ("--beta", result.diagnostics[1].name);
+        ASSERT_EQ(Diagnostic::NO_ARGV_INDEX, result.diagnostics[1].argv_index);
+        ASSERT_EQ(
+            "Argument '--alpha' required value\nArgument '--beta' required value\nArgument '--gamma' required value\n",
+            buffer.str());
+        ASSERT_EQ(1, buffer.writes);
+        ASSERT_EQ(1, buffer.flushes);
+    }
+
+    {
+        std::ostringstream errout;
+        const char* argv[] = {"test", "-a", "1", "--beta", "x"};
+        auto result =
+            Parser(options).write_diagnostics(false).process({static_cast<int>(std::size(argv)), argv}, errout);
+        options->reset_to_default();
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::WrongValueType), result.error);
+        ASSERT_EQ(1, result.diagnostics.size());
+        ASSERT_EQ(DiagnosticId::WrongValue, result.diagnostics[0].id);
+        ASSERT_EQ(3, result.diagnostics[0].argv_index);
+        ASSERT_EQ("--beta", result.diagnostics[0].name);
+        ASSERT_EQ("not a number", result.diagnostics[0].message);
+        ASSERT_EQ("", errout.str());
+        ASSERT_EQ("not a number\n", render(result.diagnostics));
+    }
+
+    {
+        const char* argv[] = {"test", "-a", "-b", "2"};
+        std::ostringstream errout;
+        auto result =
+            Parser(options).write_diagnostics(false).process({static_cast<int>(std::size(argv)), argv}, errout);
+        options->reset_to_default();
+        ASSERT_EQ(make_error_code(ProcessingArgumentsError::ExpectingValue), result.error);
+        ASSERT_EQ(0, result.diagnostics[0].argv_index);
+        ASSERT_EQ("Argument '--alpha' expected value\n", render(result.diagnostics));
+    }
+}
+
+TEST(xdx_cliopts_parser_tests, range_argv) {
+    auto options = Builder("test", "test options")
+                       .flag('v', "verbose"sv, "verbose"sv)
+                       .flag('q', "quiet"sv, "quiet"sv)
+                       .argument<std::string>("name"sv, "name"sv)
+                       .get_options();
+
+    {
+        const std::vector<std::string> argv = {"test", "-v", "--name=first", "file"};
+        auto result = Parser(options).process(argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(options->find_flag('v')->is_set());
+        ASSERT_EQ("first", options->find_typed_argument<std::string>("name")->get_value());
+        ASSERT_EQ(Parser::UnparsedArguments{"file"}, result.unparsed_arguments);
+        ASSERT_EQ(argv[3].data(), result.unparsed_arguments[0].data());
+        options->reset_to_default();
+    }
+
+    {
+        // entries sliced from one buffer aren't NUL terminated
+        const std::string_view line = "test -vq --name second tail";
+        const std::string_view argv[] = {line.substr(0, 4), line.substr(5, 3), line.substr(9, 6), line.substr(16, 6),
+                                         line.substr(23)};
+        auto result = parse_argv(options, argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(options->find_flag('v')->is_set());
+        ASSERT_TRUE(options->find_flag('q')->is_set());
+        ASSERT_EQ("second", options->find_typed_argument<std::string>("name")->get_value());
+        ASSERT_EQ(Parser::UnparsedArguments{"tail"}, result.unparsed_arguments);
+        ASSERT_EQ("test -vq --name second tail", line);
+        options->reset_to_default();
+    }
+
+    const std::vector<std::string> entries = {"test", "-v", "file"};
+    const Argv view(entries);
+    ASSERT_EQ((std::vector<std::string_view>{"-v", "file"}), std::vector<std::string_view>(view.begin(), view.end()));
+
+    const std::vector<std::string> empty;
+    Argv argv(empty);
+    ASSERT_TRUE(argv.empty());
+    ASSERT_EQ("", argv.cmd());
+    ASSERT_TRUE(argv.begin() == argv.end());
+}
+
+TEST(xdx_cliopts_parser_tests, self_argv) {
+    using Entries = std::vector<std::string_view>;
+    ASSERT_EQ((Entries{"app", "", "-v"}), details::split_cmdline("app\0\0-v\0"sv));
+    ASSERT_EQ((Entries{"app", "tail"}), details::split_cmdline("app\0tail"sv));
+    ASSERT_TRUE(details::split_cmdline(""sv).empty());
+
+    auto argv = self_argv();
+    ASSERT_FALSE(argv.cmd().empty());
+    // read once, later calls view the same buffer
+    ASSERT_EQ(argv.cmd().data(), self_argv().cmd().data());
+    ASSERT_EQ(argv.size(), self_argv().size());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/parser.hpp>
+#include <xdx/cliopts/record_reader.hpp>
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+// file is removed on close, descriptor stays valid while it lives
+struct TempInput
+{
+    explicit TempInput(std::string_view content)
+        : file{std::tmpfile()} {
+        std::fwrite(content.data(), 1, content.size(), file);
+        std::fflush(file);
+        std::rewind(file);
+    }
+
+    ~TempInput() {
+        std::fclose(file);
+    }
+
+    int fd() const {
+        return fileno(file);
+    }
+
+    std::FILE* file;
+};
+
+std::vector<std::string> read_all(RecordReader& reader) {
+    std::vector<std::string> records;
+    for (auto [not_end, record] = reader.next(); not_end; std::tie(not_end, record) = reader.next()) {
+        records.emplace_back(record);
+    }
+    return records;
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_record_reader_tests, records) {
+    const std::vector<std::string> expected = {"a", "", "long record crossing chunks", "tail"};
+    for (size_t chunk_size : {1, 3, 64 * 1024}) {
+        TempInput input("a\0\0long record crossing chunks\0tail"sv);
+        RecordReader reader(input.fd(), '\0', chunk_size);
+        ASSERT_EQ(expected, read_all(reader)) << chunk_size;
+        ASSERT_EQ(3, reader.index());
+    }
+
+    TempInput input("one\ntwo\n"sv);
+    RecordReader reader(input.fd(), '\n', 2);
+    ASSERT_EQ((std::vector<std::string>{"one", "two"}), read_all(reader));
+
+    TempInput empty(""sv);
+    RecordReader empty_reader(empty.fd());
+    ASSERT_FALSE(empty_reader.next().first);
+}
+
+TEST(xdx_cliopts_record_reader_tests, process_stream) {
+    auto options = Builder("find"sv, "streamed"sv)
+                       .flag('v', "verbose"sv, "verbose"sv)
+                       .argument<std::string>("name"sv, "name"sv)
+                       .argument_list<int>('i', "ids"sv, "ids"sv)
+                       .get_options();
+
+    TempInput input("-v\0--name\0first file\0-i\0001\0--ids=2\0second file\0-i\0003\0"sv);
+    RecordReader reader(input.fd(), '\0', 4);
+
+    std::vector<std::string> positionals;
+    std::vector<int> ids;
+    Parser::Callbacks callbacks;
+    callbacks.positional = [&positionals](std::string_view value) { positionals.emplace_back(value); };
+    callbacks.value = [&ids](iArgument& argument) {
+        if (argument.get_long_name() == "ids") {
+            auto values = dynamic_cast<ArgumentList<int>&>(argument).get_values();
+            ASSERT_EQ(1, values.size());
+            ids.push_back(values.front());
+        }
+    };
+
+    auto result = Parser(options).process_stream(reader, callbacks);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_TRUE(result.unparsed_arguments.empty());
+    ASSERT_TRUE(options->find_flag('v')->is_set());
+    ASSERT_EQ("first file", options->find_typed_argument<std::string>("name")->get_value());
+    ASSERT_EQ((std::vector<std::string>{"second file"}), positionals);
+    ASSERT_EQ((std::vector<int>{1, 2, 3}), ids);
+}
+
+TEST(xdx_cliopts_record_reader_tests, process_stream_error) {
+    auto options = Builder("find"sv, "streamed"sv).argument<int>("depth"sv, "depth"sv).get_options();
+
+    TempInput input("--depth\0deep\0"sv);
+    RecordReader reader(input.fd());
+
+    Parser::Callbacks callbacks;
+    callbacks.positional = [](std::string_view) {};
+    std::ostringstream errout;
+    auto result = Parser(options).process_stream(reader, callbacks, errout);
+    ASSERT_EQ(make_error_code(ProcessingArgumentsError::WrongValueType), result.error);
+    ASSERT_EQ(1, result.diagnostics.size());
+    ASSERT_EQ(1, result.diagnostics.front().argv_index);
+    ASSERT_FALSE(errout.str().empty());
+}
+
+TEST(xdx_cliopts_record_reader_tests, process_stream_without_positional_callback) {
+    auto options = Builder("find"sv, "streamed"sv).flag('v', "verbose"sv, "verbose"sv).get_options();
+
+    TempInput input("aaaa\0bbbb\0cccc\0"sv);
+    RecordReader reader(input.fd(), '\0', 4);
+
+    Parser::Callbacks callbacks;
+    callbacks.value = [](iArgument&) {};
+    ASSERT_THROW(Parser(options).process_stream(reader, callbacks), std::invalid_argument);
+
+    std::vector<std::string> positionals;
+    callbacks.positional = [&positionals](std::string_view value) { positionals.emplace_back(value); };
+    auto result = Parser(options).process_stream(reader, callbacks);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_TRUE(result.unparsed_arguments.empty());
+    ASSERT_EQ((std::vector<std::string>{"aaaa", "bbbb", "cccc"}), positionals);
+}
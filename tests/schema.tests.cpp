@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/cliopts.hpp>
+#include <xdx/cliopts/schema.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+enum class Mode
+{
+    Fast,
+    Safe,
+};
+
+std::string print(const OptionsPtr& options) {
+    std::ostringstream out;
+    Printer printer(options);
+    printer.print_short(out);
+    printer.print_long(out);
+    for (size_t i = 0; i < options->subcommands_count(); ++i) {
+        out << print(options->get_subcommand(i));
+    }
+    return out.str();
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_schema_tests, roundtrip_structure) {
+    auto remote = Builder("remote", "manage remotes")
+                      .flag('v', "verbose", "be verbose")
+                      .argument_list<std::string>("url"sv, "remote urls"sv, true, "URL"sv);
+    auto stash = Builder("stash", "stash changes").add_subcommand(remote.get_options());
+    const auto options = Builder("tool", "test options")
+                             .flag('q', "quiet", "quiet output")
+                             .flag_count('v', "verbose", "verbosity level")
+                             .argument<int>('j', "jobs"sv, "jobs count"sv, 4)
+                             .argument<double>("ratio"sv, "some ratio"sv)
+                             .argument_list<unsigned long>('s', "size"sv, "sizes"sv, 512ul)
+                             .add_subcommand(stash.get_options())
+                             .get_options();
+    const auto blob = serialize_schema(*options);
+    const auto loaded = load_schema(std::string_view{blob});
+
+    ASSERT_EQ("tool", loaded->get_name());
+    ASSERT_EQ(print(options), print(loaded));
+    ASSERT_EQ(blob, serialize_schema(*loaded));
+
+    const auto loaded_remote = loaded->find_subcommand("stash")->find_subcommand("remote");
+    ASSERT_TRUE(loaded_remote != nullptr);
+    ASSERT_EQ("URL", loaded_remote->find_argument("url")->get_type_name());
+    ASSERT_TRUE(loaded_remote->find_argument("url")->is_many_values());
+    ASSERT_TRUE(loaded_remote->find_argument("url")->is_required());
+    ASSERT_EQ("4", loaded->find_argument('j')->get_default_value());
+}
+
+TEST(xdx_cliopts_schema_tests, parse_with_mapped_schema) {
+    auto remote = Builder("remote", "manage remotes")
+                      .flag('v', "verbose", "be verbose")
+                      .argument_list<std::string>("url"sv, "remote urls"sv, true, "URL"sv);
+    auto stash = Builder("stash", "stash changes").add_subcommand(remote.get_options());
+    const auto source = Builder("tool", "test options")
+                            .flag('q', "quiet", "quiet output")
+                            .flag_count('v', "verbose", "verbosity level")
+                            .argument<int>('j', "jobs"sv, "jobs count"sv, 4)
+                            .argument<double>("ratio"sv, "some ratio"sv)
+                            .argument_list<unsigned long>('s', "size"sv, "sizes"sv, 512ul)
+                            .add_subcommand(stash.get_options())
+                            .get_options();
+
+    const auto path = testing::TempDir() + "xdx_cliopts_schema.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << serialize_schema(*source);
+    }
+
+    const auto options = load_schema(path);
+    std::remove(path.c_str());
+
+    {
+        const char* argv[] = {"tool", "-vv", "--ratio=0.5", "-s", "1", "-s", "2", "stash", "remote", "--url", "a"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+
+        ASSERT_EQ(2, std::static_pointer_cast<SchemaFlag>(options->find_flag('v'))->get_count());
+        ASSERT_FALSE(options->find_flag("quiet")->is_set());
+        ASSERT_EQ(4, std::static_pointer_cast<SchemaArgument>(options->find_argument("jobs"))->get_value<int>());
+        ASSERT_EQ(0.5, std::static_pointer_cast<SchemaArgument>(options->find_argument("ratio"))->get_value<double>());
+        ASSERT_EQ((std::vector<unsigned long>{1, 2}),
+                  std::static_pointer_cast<SchemaArgument>(options->find_argument('s'))->get_values<unsigned long>());
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"tool", "--ratio", "fast"};
+        auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+        ASSERT_TRUE(static_cast<bool>(result.error));
+        ASSERT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        options->reset_to_default();
+    }
+
+    {
+        const char* argv[] = {"tool", "--ratio", "1", "stash", "remote"};
+        std::ostringstream errout;
+        auto result = Parser(options).process({static_cast<int>(std::size(argv)), argv}, errout);
+        ASSERT_EQ(ProcessingArgumentsError::RequiredArgument,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("Argument '--url' required value\n", errout.str());
+    }
+}
+
+TEST(xdx_cliopts_schema_tests, converted_values_follow_changes) {
+    const auto blob = serialize_schema(*Builder("tool", "test options")
+                                            .argument<int>('j', "jobs"sv, "jobs count"sv, 4)
+                                            .argument_list<unsigned long>('s', "size"sv, "sizes"sv, 512ul)
+                                            .get_options());
+    const auto options = load_schema(std::string_view{blob});
+    const auto jobs = std::static_pointer_cast<SchemaArgument>(options->find_argument('j'));
+    const auto sizes = std::static_pointer_cast<SchemaArgument>(options->find_argument('s'));
+
+    ASSERT_EQ(4, jobs->get_value<int>());
+    ASSERT_EQ(4, jobs->get_value<int>());
+    ASSERT_EQ(4.0, jobs->get_value<double>());
+    ASSERT_TRUE(jobs->set_string_value("7").first);
+    ASSERT_EQ(7, jobs->get_value<int>());
+
+    ASSERT_EQ((std::vector<unsigned long>{512}), sizes->get_values<unsigned long>());
+    ASSERT_TRUE(sizes->set_string_value("1").first);
+    ASSERT_TRUE(sizes->set_string_value("2").first);
+    ASSERT_EQ((std::vector<unsigned long>{1, 2}), sizes->get_values<unsigned long>());
+
+    options->reset_to_default();
+    ASSERT_EQ(4, jobs->get_value<int>());
+    ASSERT_EQ((std::vector<unsigned long>{512}), sizes->get_values<unsigned long>());
+}
+
+TEST(xdx_cliopts_schema_tests, roundtrip_validation) {
+    auto builder = Builder("tool", "test options")
+                       .choice<Mode>('m', "mode"sv, "processing mode"sv, {{"fast", Mode::Fast}, {"safe", Mode::Safe}},
+                                     Mode::Safe)
+                       .argument_list<int>("ids"sv, "some ids"sv, false);
+    builder.get_options()->find_typed_argument_list<int>("ids")->set_delimiter(',', '\\');
+    const auto blob = serialize_schema(*builder.get_options());
+    const auto options = load_schema(std::string_view{blob});
+    ASSERT_EQ(blob, serialize_schema(*options));
+
+    const auto mode = std::static_pointer_cast<SchemaArgument>(options->find_argument('m'));
+    ASSERT_EQ(2, mode->allowed_values_count());
+    ASSERT_EQ("safe", mode->get_allowed_value(1));
+    ASSERT_EQ("safe", mode->get_value<std::string>());
+    ASSERT_FALSE(mode->set_string_value("slow").first);
+    ASSERT_TRUE(mode->set_string_value("fast").first);
+    ASSERT_EQ("fast", mode->get_value<std::string>());
+
+    const auto ids = std::static_pointer_cast<SchemaArgument>(options->find_argument("ids"));
+    ASSERT_EQ(',', ids->get_delimiter());
+    ASSERT_TRUE(ids->set_string_value("1,2").first);
+    ASSERT_FALSE(ids->set_string_value("3,x").first);
+    ASSERT_EQ((std::vector<int>{1, 2}), ids->get_values<int>());
+}
+
+TEST(xdx_cliopts_schema_tests, indexed_lookups) {
+    auto remote = Builder("remote", "manage remotes").flag('v', "verbose", "be verbose");
+    auto stash = Builder("stash", "stash changes");
+    auto status = Builder("status", "show status");
+    const auto blob = serialize_schema(*Builder("tool", "test options")
+                                            .flag('q', "quiet", "quiet output")
+                                            .flag("quick", "quick mode")
+                                            .argument<int>('j', "jobs"sv, "jobs count"sv, 4)
+                                            .add_subcommand(status.get_options())
+                                            .add_subcommand(remote.get_options())
+                                            .add_subcommand(stash.get_options())
+                                            .get_options());
+    const auto options = load_schema(std::string_view{blob});
+
+    ASSERT_EQ(options->find_flag('q'), options->find_flag("quiet"));
+    ASSERT_EQ(options->get_flag(0), options->find_flag("quiet"));
+    ASSERT_EQ(nullptr, options->find_flag('j'));
+    ASSERT_EQ(nullptr, options->find_argument("quiet"));
+    ASSERT_EQ(nullptr, options->find_flag("qui"));
+    ASSERT_EQ(options->find_argument('j'), options->find_argument("jobs"));
+
+    ASSERT_EQ(2, std::get<0>(options->find_long_name_prefix("qu")));
+    ASSERT_EQ(options->find_flag("quick"), std::get<1>(options->find_long_name_prefix("quic")));
+    ASSERT_EQ(options->find_argument("jobs"), std::get<2>(options->find_long_name_prefix("j")));
+    ASSERT_EQ(0, std::get<0>(options->find_long_name_prefix("")));
+    ASSERT_EQ(0, std::get<0>(options->find_long_name_prefix("x")));
+
+    ASSERT_EQ(options->get_subcommand(1), options->find_subcommand("remote"));
+    ASSERT_EQ(nullptr, options->find_subcommand("sta"));
+    ASSERT_EQ(2, options->find_subcommand_prefix("sta").first);
+    ASSERT_EQ(options->get_subcommand(2), options->find_subcommand_prefix("stas").second);
+    ASSERT_EQ(0, options->find_subcommand_prefix("").first);
+
+    const char* argv[] = {"tool", "--quic", "rem", "--verb"};
+    auto result = Parser(options)
+                      .allow_long_abbreviations()
+                      .allow_subcommand_abbreviations()
+                      .process({static_cast<int>(std::size(argv)), argv});
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_TRUE(options->find_flag("quick")->is_set());
+    ASSERT_TRUE(options->find_subcommand("remote")->find_flag('v')->is_set());
+
+    options->reset_to_default();
+    ASSERT_FALSE(options->find_flag("quick")->is_set());
+    ASSERT_FALSE(options->find_subcommand("remote")->find_flag('v')->is_set());
+}
+
+TEST(xdx_cliopts_schema_tests, malformed_blob) {
+    auto blob = serialize_schema(*Builder("tool", "test options")
+                                      .flag('q', "quiet", "quiet output")
+                                      .argument<int>('j', "jobs"sv, "jobs count"sv, 4)
+                                      .get_options());
+    ASSERT_THROW(load_schema(std::string_view{blob}.substr(0, blob.size() - 1)), std::invalid_argument);
+    blob[0] = 'Z';
+    ASSERT_THROW(load_schema(std::string_view{blob}), std::invalid_argument);
+    ASSERT_THROW(load_schema(testing::TempDir() + "xdx_cliopts_missing_schema.bin"), std::system_error);
+
+    const auto path = testing::TempDir() + "xdx_cliopts_empty_schema.bin";
+    std::ofstream{path};
+    ASSERT_THROW(load_schema(path), std::invalid_argument);
+    std::remove(path.c_str());
+    ASSERT_THROW(load_schema(std::string_view{blob})->add(std::make_shared<Flag>('x', "x")), std::logic_error);
+}
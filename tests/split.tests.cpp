@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/details/split.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+std::vector<std::string> split(std::string_view text, char delimiter = ',', char escape = '\\') {
+    std::vector<std::string> result;
+    std::string buffer;
+    details::for_each_slice(text, delimiter, escape, buffer, [&result](std::string_view slice) {
+        result.emplace_back(slice);
+        return true;
+    });
+    return result;
+}
+
+}  // namespace
+
+TEST(xdx_cliopts_split_tests, count_char) {
+    ASSERT_EQ(0, details::count_char("", ','));
+    ASSERT_EQ(2, details::count_char("1,2,3", ','));
+
+    std::string text;
+    for (int idx = 0; idx < 1000; ++idx) {
+        text += std::to_string(idx) + ",";
+    }
+    ASSERT_EQ(1000, details::count_char(text, ','));
+    ASSERT_EQ(1000, details::count_char(std::string_view{text}.substr(1), ','));
+}
+
+TEST(xdx_cliopts_split_tests, find_any) {
+    const auto text = "0123456789abcdefghijklmnopqrstuvwxyz,"sv;
+    ASSERT_EQ(36, details::find_any(text, 0, ',', ','));
+    ASSERT_EQ(20, details::find_any(text, 0, ',', 'k'));
+    ASSERT_EQ(36, details::find_any(text, 21, ',', 'k'));
+    ASSERT_EQ(text.npos, details::find_any(text, 37, ',', 'k'));
+    ASSERT_EQ(text.npos, details::find_any(text, 0, '!', '?'));
+}
+
+TEST(xdx_cliopts_split_tests, slices) {
+    ASSERT_EQ((std::vector<std::string>{""}), split(""));
+    ASSERT_EQ((std::vector<std::string>{"a", "", "b", ""}), split("a,,b,"));
+    ASSERT_EQ((std::vector<std::string>{"a,b", "c\\d", "e"}), split("a\\,b,c\\\\d,e"));
+    ASSERT_EQ((std::vector<std::string>{"a\\,b"}), split("a\\,b", ';', '\0'));
+    ASSERT_EQ((std::vector<std::string>{"trailing\\"}), split("trailing\\"));
+    ASSERT_EQ((std::vector<std::string>{"a very long element with, inside", "and the next one"}),
+              split("a very long element with\\, inside,and the next one"));
+}
+
+TEST(xdx_cliopts_split_tests, parse_delimited) {
+    std::vector<int> values{-1};
+    ASSERT_TRUE(details::parse_delimited("1,2,3", ',', '\\', &values).first);
+    ASSERT_EQ((std::vector<int>{-1, 1, 2, 3}), values);
+
+    const auto [success, error] = details::parse_delimited("4,x,6", ',', '\\', &values);
+    ASSERT_FALSE(success);
+    ASSERT_EQ("not a number", error);
+    ASSERT_EQ((std::vector<int>{-1, 1, 2, 3}), values);
+
+    std::string text;
+    for (int idx = 0; idx < 100000; ++idx) {
+        text += (idx != 0 ? "," : "") + std::to_string(idx);
+    }
+    std::vector<int> many;
+    ASSERT_TRUE(details::parse_delimited(text, ',', '\\', &many).first);
+    ASSERT_EQ(100000, many.size());
+    ASSERT_EQ(100000, many.capacity());
+    ASSERT_EQ(99999, many.back());
+
+    // repeated occurrences don't reallocate on each one
+    std::vector<int> repeated;
+    size_t reallocations = 0;
+    for (int idx = 0; idx < 1000; ++idx) {
+        const auto capacity = repeated.capacity();
+        ASSERT_TRUE(details::parse_delimited("1,2", ',', '\\', &repeated).first);
+        reallocations += repeated.capacity() != capacity ? 1 : 0;
+    }
+    ASSERT_EQ(2000, repeated.size());
+    ASSERT_GE(11, reallocations);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/builder.hpp>
+#include <xdx/cliopts/choice.hpp>
+#include <xdx/cliopts/parser.hpp>
+#include <xdx/cliopts/schema.hpp>
+#include <xdx/cliopts/state.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+enum class Mode
+{
+    Fast,
+    Safe,
+};
+
+}  // namespace
+
+TEST(xdx_cliopts_state_tests, round_trip) {
+    double ratio = 0.5;
+    std::vector<int> ids;
+    Builder build("build"sv, "build command"sv);
+    build.flag('r', "release"sv, "release build"sv)
+        .argument<std::string>('o', "output"sv, "output file"sv, false)
+        .argument_list<std::string>("define"sv, "defines"sv, false);
+    auto options = Builder("tool"sv, "test tool"sv)
+                       .flag_count('v', "verbose"sv, "verbosity"sv)
+                       .flag('q', "quiet"sv, "quiet"sv)
+                       .argument<int>('j', "jobs"sv, "jobs count"sv, 1)
+                       .choice<Mode>("mode"sv, "mode"sv, {{"fast", Mode::Fast}, {"safe", Mode::Safe}}, Mode::Safe)
+                       .argument(&ratio, "ratio"sv, "ratio"sv)
+                       .argument_list(&ids, "id"sv, "ids"sv, false)
+                       .add_subcommand(build.get_options())
+                       .get_options();
+
+    // values which weren't given keep defaults and aren't written
+    const auto empty = serialize_state(*options, {});
+
+    const char* argv[] = {"tool", "-vv", "--jobs=8", "--mode", "fast", "--id", "3", "--id", "4", "--ratio", "0.25",
+                          "build", "-r", "-o", "a b", "--define=X", "--define=Y"};
+    auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+
+    const auto blob = serialize_state(*options, result.subcommand_path);
+
+    // restored tree is reset first, so nothing parsed before survives
+    options->reset_to_default();
+    ASSERT_TRUE(ids.empty());
+    options->find_flag('q')->set_found();
+    auto path = restore_state(blob, *options);
+
+    ASSERT_EQ(Parser::SubcommandsPath{"build"}, path);
+    ASSERT_EQ(options->find_subcommand("build")->get_name().data(), path[0].data());
+    ASSERT_EQ(2, options->find_flag_count('v')->get_count());
+    ASSERT_FALSE(options->find_flag('q')->is_set());
+    ASSERT_EQ(8, options->find_typed_argument<int>('j')->get_value());
+    ASSERT_EQ(Mode::Fast, options->find_choice<Mode>("mode")->get_value());
+    ASSERT_EQ(0.25, ratio);
+    ASSERT_EQ((std::vector<int>{3, 4}), ids);
+
+    auto restored_build = options->find_subcommand("build");
+    ASSERT_TRUE(restored_build->find_flag('r')->is_set());
+    ASSERT_EQ("a b", restored_build->find_typed_argument<std::string>('o')->get_value());
+    ASSERT_EQ((std::vector<std::string>{"X", "Y"}),
+              restored_build->find_typed_argument_list<std::string>("define")->get_values());
+
+    ASSERT_LT(empty.size(), blob.size());
+    ASSERT_TRUE(restore_state(empty, *options).empty());
+    ASSERT_EQ(1, options->find_typed_argument<int>('j')->get_value());
+    ASSERT_EQ(0.5, ratio);
+}
+
+TEST(xdx_cliopts_state_tests, schema_options) {
+    const auto schema = serialize_schema(*Builder("tool"sv, "test tool"sv)
+                                              .flag_count('v', "verbose"sv, "verbosity"sv)
+                                              .argument<int>('j', "jobs"sv, "jobs count"sv, 1)
+                                              .get_options());
+    auto parsed = load_schema(std::string_view(schema));
+    const char* argv[] = {"tool", "-v", "--jobs=3"};
+    auto result = parse_argv(parsed, static_cast<int>(std::size(argv)), argv);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+
+    auto options = load_schema(std::string_view(schema));
+    restore_state(serialize_state(*parsed, result.subcommand_path), *options);
+    ASSERT_EQ(1, options->find_flag('v')->get_count());
+    ASSERT_EQ(3, std::dynamic_pointer_cast<SchemaArgument>(options->find_argument('j'))->get_value<int>());
+}
+
+TEST(xdx_cliopts_state_tests, malformed) {
+    auto build = Builder("build"sv, "build command"sv).flag('r', "release"sv, "release build"sv);
+    auto options = Builder("tool"sv, "test tool"sv)
+                       .argument<int>('j', "jobs"sv, "jobs count"sv, 1)
+                       .add_subcommand(build.get_options())
+                       .get_options();
+    const char* argv[] = {"tool", "--jobs=8", "build"};
+    auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+    const auto blob = serialize_state(*options, result.subcommand_path);
+
+    ASSERT_THROW(restore_state("XDXS"sv, *options), std::invalid_argument);
+    ASSERT_THROW(restore_state(std::string_view(blob).substr(0, blob.size() - 1), *options), std::invalid_argument);
+    ASSERT_THROW(restore_state(blob + "x", *options), std::invalid_argument);
+    // values read before the error are reset
+    ASSERT_EQ(1, options->find_typed_argument<int>('j')->get_value());
+    ASSERT_THROW(serialize_state(*options, {"unknown"}), std::invalid_argument);
+
+    // count of values is checked against blob size before storage is reserved
+    std::string huge("XDXP", 4);
+    for (uint32_t value : {1u, 0u, 0u, 1u, 0u, 0xffffffffu}) {
+        huge.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    auto ids = Builder("tool"sv, "test tool"sv).argument_list<int>("id"sv, "ids"sv, false).get_options();
+    ASSERT_THROW(restore_state(huge, *ids), std::invalid_argument);
+
+    auto other = Builder("tool"sv, "test tool"sv).flag('v', "verbose"sv, "verbosity"sv).get_options();
+    ASSERT_THROW(restore_state(blob, *other), std::invalid_argument);
+}
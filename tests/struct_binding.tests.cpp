@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <xdx/cliopts/cliopts.hpp>
+
+#include <sstream>
+
+using namespace xdx::cliopts;
+using namespace std::literals;
+
+namespace
+{
+
+struct Config
+{
+    bool verbose = false;
+    size_t quiet = 0;
+    int jobs = 1;
+    std::string name;
+    std::vector<int> ids{7};
+};
+
+const StructBinding config_binding("test", "test options",
+                                   field(&Config::verbose, 'v', "verbose", "verbose output"),
+                                   count_field(&Config::quiet, 'q', "", "quiet output"),
+                                   field(&Config::jobs, 'j', "jobs", "jobs count"),
+                                   field(&Config::name, '\0', "name", "required name", true),
+                                   field(&Config::ids, 'i', "id", "ids"));
+
+}  // namespace
+
+TEST(xdx_cliopts_struct_binding_tests, process) {
+    {
+        Config config;
+        const char* argv[] = {"test", "-vqq", "--name=x", "-j", "4", "-i", "1", "--id=2", "file"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_TRUE(config.verbose);
+        ASSERT_EQ(2, config.quiet);
+        ASSERT_EQ(4, config.jobs);
+        ASSERT_EQ("x", config.name);
+        ASSERT_EQ((std::vector<int>{1, 2}), config.ids);
+        ASSERT_EQ((Parser::UnparsedArguments{"file"}), result.unparsed_arguments);
+    }
+
+    {
+        Config config;
+        const char* argv[] = {"test", "--name", "x"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config);
+        ASSERT_FALSE(static_cast<bool>(result.error));
+        ASSERT_EQ(1, config.jobs);
+        ASSERT_EQ((std::vector<int>{7}), config.ids);
+    }
+
+    {
+        Config config;
+        std::ostringstream errout;
+        const char* argv[] = {"test", "-j", "4"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config, errout);
+        ASSERT_EQ(ProcessingArgumentsError::RequiredArgument,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("Argument '--name' required value\n", errout.str());
+    }
+
+    {
+        Config config;
+        std::ostringstream errout;
+        const char* argv[] = {"test", "-j", "many"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config, errout);
+        ASSERT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+    }
+
+    {
+        Config config;
+        std::ostringstream errout;
+        const char* argv[] = {"test", "--unknown"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config, errout);
+        ASSERT_EQ(ProcessingArgumentsError::UnknonwSwitcher,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ("Unknown switcher: '--unknown'\n", errout.str());
+    }
+
+    {
+        Config config;
+        std::ostringstream errout;
+        const auto parser = Parser(nullptr).allow_long_abbreviations().write_diagnostics(false);
+        const char* argv[] = {"test", "--verb", "--na=x", "-j", "many"};
+        auto result = config_binding.process({static_cast<int>(std::size(argv)), argv}, config, parser, errout);
+        ASSERT_EQ(ProcessingArgumentsError::WrongValueType,
+                  static_cast<ProcessingArgumentsError>(result.error.value()));
+        ASSERT_EQ(1, result.diagnostics.size());
+        ASSERT_EQ("", errout.str());
+        ASSERT_TRUE(config.verbose);
+        ASSERT_EQ("x", config.name);
+    }
+}
+
+TEST(xdx_cliopts_struct_binding_tests, describe) {
+    Config config;
+    auto options = config_binding.describe(config);
+    ASSERT_EQ("test", options->get_name());
+    ASSERT_EQ(5, options->flags_count() + options->arguments_count());
+    ASSERT_TRUE(options->find_flag('q')->is_countable());
+    ASSERT_EQ("1", options->find_argument("jobs")->get_default_value());
+    ASSERT_TRUE(options->find_argument("name")->is_required());
+
+    const char* argv[] = {"test", "--name", "y", "-j", "3"};
+    auto result = parse_argv(options, static_cast<int>(std::size(argv)), argv);
+    ASSERT_FALSE(static_cast<bool>(result.error));
+    ASSERT_EQ("y", config.name);
+    ASSERT_EQ(3, config.jobs);
+
+    std::ostringstream out;
+    config_binding.print_long(out, config);
+    ASSERT_NE(std::string::npos, out.str().find("--jobs"));
+}
@@ -2,6 +2,7 @@
 #include <xdx/cliopts/tokenizer.hpp>
 
 using namespace xdx::cliopts;
+using namespace std::literals;
 
 TEST(xdx_cliopts_tokenizer_tests, tokenize_simple) {
     const char* arguments[] = {"program", "a", "b", "c"};
@@ -132,3 +133,26 @@ TEST(xdx_cliopts_tokenizer_tests, tokenize_long_and_none) {
         ASSERT_EQ(Tokenizer::TokenType::Unknown, token.type);
     }
 }
+
+TEST(xdx_cliopts_tokenizer_tests, argv_view) {
+    const char* arguments[] = {"program", "-a", "b", "-c", "d"};
+    Argv args(static_cast<int>(std::size(arguments)), arguments);
+    ASSERT_EQ("program", args.cmd());
+    ASSERT_EQ(4, args.size());
+    ASSERT_EQ("-a"sv, arguments[1]);
+
+    Tokenizer tokenizer(args);
+    tokenizer.next();
+    ASSERT_EQ(0, tokenizer.entry());
+    tokenizer.next();
+    ASSERT_EQ(1, tokenizer.entry());
+
+    args.erase(1);
+    ASSERT_EQ(3, args.size());
+    ASSERT_EQ("-c"sv, args[1]);
+
+    args.compact([](size_t idx) { return idx != 1; });
+    ASSERT_EQ(2, args.size());
+    ASSERT_EQ("-a"sv, args[0]);
+    ASSERT_EQ("d"sv, args[1]);
+}